@@ -0,0 +1,201 @@
+// Concurrent_Hash_Set.hpp
+#ifndef CONCURRENT_HASH_SET_HPP
+#define CONCURRENT_HASH_SET_HPP
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include "Hash_Map.hpp"
+
+template <typename ElementType>
+class ConcurrentHashSet : public Set<ElementType>
+{
+public:
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    explicit ConcurrentHashSet(HashFunction hashFunction,
+        unsigned int shardCount = 0);
+    ~ConcurrentHashSet() noexcept override;
+
+    ConcurrentHashSet(const ConcurrentHashSet& s) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet& s) = delete;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+    bool insert(const ElementType& element);
+    bool insert(ElementType&& element);
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int shardCount() const noexcept;
+    void reserve(unsigned int count);
+
+private:
+    using Table = impl_::HashTable<ElementType,
+        impl_::HashTable__identity<ElementType>>;
+
+    // Each shard sits on its own cache line so that writers on neighbouring
+    // shards do not invalidate each other's lock word. Shards hold the
+    // HashSet engine directly, so the hash that picked the shard is reused
+    // for the bucket.
+    struct alignas(64) Shard {
+
+        explicit Shard(const HashFunction& hashFunction);
+
+        mutable std::shared_mutex lock;
+        Table table;
+    };
+
+    HashFunction hashFunction;
+    std::unique_ptr<std::unique_ptr<Shard>[]> shards;
+    unsigned int shardMask;
+
+    Shard& shardOf(unsigned int hash) const noexcept;
+};
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::Shard::Shard(const HashFunction& hashFunction)
+    : table{ hashFunction }
+{
+}
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::ConcurrentHashSet(HashFunction hashFunction,
+    unsigned int shardCount)
+    : hashFunction{ hashFunction }, shards{ nullptr }, shardMask{ 0 }
+{
+    if(shardCount == 0) {
+
+        shardCount = std::thread::hardware_concurrency() * 4;
+    }
+
+    unsigned int count = 1;
+    while(count < shardCount) {
+
+        count <<= 1;
+    }
+
+    shards.reset(new std::unique_ptr<Shard>[count]);
+    for(unsigned int i = 0; i < count; ++i) {
+
+        shards[i].reset(new Shard{ hashFunction });
+    }
+
+    shardMask = count - 1;
+}
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::~ConcurrentHashSet() noexcept
+{
+}
+
+
+template <typename ElementType>
+typename ConcurrentHashSet<ElementType>::Shard&
+    ConcurrentHashSet<ElementType>::shardOf(unsigned int hash) const noexcept
+{
+    return *shards[impl_::HashTable__shardIndex(hash, shardMask)];
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void ConcurrentHashSet<ElementType>::add(const ElementType& element)
+{
+    insert(element);
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::insert(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::unique_lock<std::shared_mutex> guard{ shard.lock };
+
+    return shard.table.emplace(hash, element, element).second;
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::insert(ElementType&& element)
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::unique_lock<std::shared_mutex> guard{ shard.lock };
+
+    return shard.table.emplace(hash, element, std::move(element)).second;
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::remove(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::unique_lock<std::shared_mutex> guard{ shard.lock };
+
+    return shard.table.removeHashed(hash, element);
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::shared_lock<std::shared_mutex> guard{ shard.lock };
+
+    return shard.table.containsHashed(hash, element);
+}
+
+
+// Shards are read one at a time, so the total is only exact when no writer
+// runs concurrently.
+template <typename ElementType>
+unsigned int ConcurrentHashSet<ElementType>::size() const noexcept
+{
+    unsigned int total = 0;
+
+    for(unsigned int i = 0; i <= shardMask; ++i) {
+
+        std::shared_lock<std::shared_mutex> guard{ shards[i]->lock };
+        total += shards[i]->table.size();
+    }
+
+    return total;
+}
+
+
+template <typename ElementType>
+unsigned int ConcurrentHashSet<ElementType>::shardCount() const noexcept
+{
+    return shardMask + 1;
+}
+
+
+template <typename ElementType>
+void ConcurrentHashSet<ElementType>::reserve(unsigned int count)
+{
+    unsigned int perShard = count / (shardMask + 1) + 1;
+
+    for(unsigned int i = 0; i <= shardMask; ++i) {
+
+        std::unique_lock<std::shared_mutex> guard{ shards[i]->lock };
+        shards[i]->table.reserve(perShard);
+    }
+}
+
+#endif // CONCURRENT_HASH_SET_HPP
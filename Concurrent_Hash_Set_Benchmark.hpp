@@ -0,0 +1,135 @@
+// Concurrent_Hash_Set_Benchmark.hpp
+#ifndef CONCURRENT_HASH_SET_BENCHMARK_HPP
+#define CONCURRENT_HASH_SET_BENCHMARK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Concurrent_Hash_Set.hpp"
+
+// Throughput of one run of benchmarkThreadScaling(). speedup is relative to
+// the first thread count measured, and hits counts the lookups that found
+// their key.
+struct ConcurrentHashSetScaling
+{
+    unsigned int threadCount;
+    double operationsPerSecond;
+    double speedup;
+    unsigned long long hits;
+};
+
+
+// Runs the same mixed workload on a fresh ConcurrentHashSet once per entry
+// of threadCounts. The set starts with every other key of keys. Each thread
+// then performs operationsPerThread operations on keys drawn at random:
+// lookups with probability readFraction, and otherwise an insert or a
+// remove. Threads start together and the clock stops when the last one is
+// done.
+template <typename ElementType>
+std::vector<ConcurrentHashSetScaling> benchmarkThreadScaling(
+    const std::vector<ElementType>& keys,
+    typename ConcurrentHashSet<ElementType>::HashFunction hashFunction,
+    const std::vector<unsigned int>& threadCounts, double readFraction = 0.9,
+    unsigned int operationsPerThread = 1u << 20, unsigned int shardCount = 0)
+{
+    std::vector<ConcurrentHashSetScaling> results;
+
+    if(keys.empty()) {
+
+        return results;
+    }
+
+    unsigned int readThreshold =
+        static_cast<unsigned int>(readFraction * 0xffffffffu);
+
+    for(unsigned int threadCount : threadCounts) {
+
+        ConcurrentHashSet<ElementType> s{ hashFunction, shardCount };
+        s.reserve(static_cast<unsigned int>(keys.size()));
+
+        for(std::size_t i = 0; i < keys.size(); i += 2) {
+
+            s.insert(keys[i]);
+        }
+
+        std::atomic<bool> go{ false };
+        std::atomic<unsigned long long> hits{ 0 };
+        std::vector<std::thread> threads;
+
+        for(unsigned int t = 0; t < threadCount; ++t) {
+
+            threads.emplace_back([&, t]() {
+
+                unsigned int state = 0x9e3779b9u * (t + 1);
+                unsigned long long found = 0;
+
+                auto next = [&state]() {
+
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+
+                    return state;
+                };
+
+                while(!go.load(std::memory_order_acquire)) {
+
+                    std::this_thread::yield();
+                }
+
+                for(unsigned int i = 0; i < operationsPerThread; ++i) {
+
+                    const ElementType& key = keys[next() % keys.size()];
+                    unsigned int kind = next();
+
+                    if(kind < readThreshold) {
+
+                        found += s.contains(key);
+                    }
+                    else if((kind & 1) != 0) {
+
+                        s.insert(key);
+                    }
+                    else {
+
+                        s.remove(key);
+                    }
+                }
+
+                hits += found;
+            });
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+
+        for(std::thread& thread : threads) {
+
+            thread.join();
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - started).count();
+        double operations = static_cast<double>(threadCount) *
+            operationsPerThread;
+
+        ConcurrentHashSetScaling result;
+        result.threadCount = threadCount;
+        result.operationsPerSecond = seconds > 0.0 ? operations / seconds : 0.0;
+        result.speedup = 1.0;
+        result.hits = hits.load();
+
+        if(!results.empty() && results[0].operationsPerSecond > 0.0) {
+
+            result.speedup =
+                result.operationsPerSecond / results[0].operationsPerSecond;
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+#endif // CONCURRENT_HASH_SET_BENCHMARK_HPP
@@ -0,0 +1,610 @@
+// Cuckoo_Hash_Set.hpp
+#ifndef CUCKOO_HASH_SET_HPP
+#define CUCKOO_HASH_SET_HPP
+
+#include <new>
+#include <utility>
+#include <vector>
+#include "Hash_Map.hpp"
+
+// Bucketized cuckoo hash set. Every element lives in one of two candidate
+// buckets of four slots each, so contains() inspects at most two buckets.
+// A bucket is cache-line aligned and, for elements of up to 11 bytes, fits
+// in a single line. Inserts that find both buckets full displace residents
+// along a bounded random walk. An element the walk cannot place goes to a
+// small stash, which lookups search after the two buckets, and the table
+// doubles if it is at least half full. Elements that share one hash with
+// more than two buckets' worth of others can never be placed, so they stay
+// in the stash however large the table grows. Growth stops at
+// MAX_BUCKET_COUNT buckets, after which failed walks only fill the stash.
+template <typename ElementType>
+class CuckooHashSet : public Set<ElementType>
+{
+public:
+    static constexpr unsigned int SLOTS_PER_BUCKET = 4;
+    static constexpr unsigned int DEFAULT_BUCKET_COUNT = 4;
+    static constexpr unsigned int MAX_DISPLACEMENTS = 500;
+    static constexpr unsigned int MAX_BUCKET_COUNT = 1u << 28;
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    explicit CuckooHashSet(HashFunction hashFunction);
+    ~CuckooHashSet() noexcept override;
+
+    CuckooHashSet(const CuckooHashSet& s);
+    CuckooHashSet(CuckooHashSet&& s) noexcept;
+
+    CuckooHashSet& operator=(const CuckooHashSet& s);
+    CuckooHashSet& operator=(CuckooHashSet&& s) noexcept;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+    bool insert(const ElementType& element);
+    bool insert(ElementType&& element);
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int bucketCount() const noexcept;
+    double loadFactor() const noexcept;
+    void reserve(unsigned int count);
+
+private:
+    struct alignas(64) Bucket {
+
+        unsigned int hashes[SLOTS_PER_BUCKET];
+        unsigned char occupied;
+        alignas(ElementType) unsigned char
+            storage[sizeof(ElementType) * SLOTS_PER_BUCKET];
+
+        ElementType& value(unsigned int slot) noexcept;
+        const ElementType& value(unsigned int slot) const noexcept;
+    };
+
+    struct Entry {
+
+        unsigned int hash;
+        ElementType value;
+    };
+
+    HashFunction hashFunction;
+    Bucket* buckets;
+    std::vector<Entry> stash;
+    unsigned int sz, capacity;
+    unsigned int randomState;
+
+    static unsigned int primaryIndex(unsigned int hash, unsigned int mask) noexcept;
+    static unsigned int alternateIndex(unsigned int hash, unsigned int mask) noexcept;
+
+    static void destroyBuckets(Bucket* table, unsigned int count) noexcept;
+    static bool placeInFreeSlot(Bucket& b, unsigned int hash,
+        ElementType& element);
+
+    unsigned int nextRandom() noexcept;
+    void destroyAll() noexcept;
+    void copyFrom(const CuckooHashSet& s);
+    bool findSlot(unsigned int hash, const ElementType& element,
+        unsigned int& bucket, unsigned int& slot) const;
+    int findStashed(unsigned int hash, const ElementType& element) const;
+    void place(Bucket* table, unsigned int mask, unsigned int hash,
+        ElementType& element, std::vector<Entry>& overflow);
+    void rehashTo(unsigned int newCapacity);
+
+    template <typename Value>
+    bool insert_(Value&& element);
+};
+
+
+template <typename ElementType>
+ElementType& CuckooHashSet<ElementType>::Bucket::value(unsigned int slot) noexcept
+{
+    return reinterpret_cast<ElementType*>(storage)[slot];
+}
+
+
+template <typename ElementType>
+const ElementType& CuckooHashSet<ElementType>::Bucket::value(
+    unsigned int slot) const noexcept
+{
+    return reinterpret_cast<const ElementType*>(storage)[slot];
+}
+
+
+template <typename ElementType>
+CuckooHashSet<ElementType>::CuckooHashSet(HashFunction hashFunction)
+    : hashFunction{ hashFunction }, buckets{ nullptr }, sz{ 0 },
+      capacity{ DEFAULT_BUCKET_COUNT }, randomState{ 0x9e3779b9u }
+{
+    buckets = new Bucket[capacity]();
+}
+
+
+template <typename ElementType>
+CuckooHashSet<ElementType>::~CuckooHashSet() noexcept
+{
+    destroyAll();
+}
+
+
+template <typename ElementType>
+CuckooHashSet<ElementType>::CuckooHashSet(const CuckooHashSet& s)
+    : hashFunction{ s.hashFunction }, buckets{ nullptr }, sz{ 0 },
+      capacity{ 0 }, randomState{ s.randomState }
+{
+    copyFrom(s);
+}
+
+
+// Leaves s without buckets. Every member treats capacity 0 as an empty set,
+// and the next insert allocates DEFAULT_BUCKET_COUNT buckets.
+template <typename ElementType>
+CuckooHashSet<ElementType>::CuckooHashSet(CuckooHashSet&& s) noexcept
+    : hashFunction{ s.hashFunction }, buckets{ nullptr }, sz{ 0 },
+      capacity{ 0 }, randomState{ s.randomState }
+{
+    std::swap(buckets, s.buckets);
+    std::swap(stash, s.stash);
+    std::swap(sz, s.sz);
+    std::swap(capacity, s.capacity);
+}
+
+
+template <typename ElementType>
+CuckooHashSet<ElementType>& CuckooHashSet<ElementType>::operator=(
+    const CuckooHashSet& s)
+{
+    if(this != &s) {
+
+        CuckooHashSet copy{ s };
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+CuckooHashSet<ElementType>& CuckooHashSet<ElementType>::operator=(
+    CuckooHashSet&& s) noexcept
+{
+    if(this != &s) {
+
+        std::swap(hashFunction, s.hashFunction);
+        std::swap(buckets, s.buckets);
+        std::swap(stash, s.stash);
+        std::swap(sz, s.sz);
+        std::swap(capacity, s.capacity);
+    }
+
+    return *this;
+}
+
+
+// The two candidate buckets come from independent finalizers applied to the
+// one user hash, so the user only supplies a single HashFunction.
+template <typename ElementType>
+unsigned int CuckooHashSet<ElementType>::primaryIndex(unsigned int hash,
+    unsigned int mask) noexcept
+{
+    return impl_::HashTable__mix(hash) & mask;
+}
+
+
+template <typename ElementType>
+unsigned int CuckooHashSet<ElementType>::alternateIndex(unsigned int hash,
+    unsigned int mask) noexcept
+{
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    hash *= 0x297a2d39u;
+    hash ^= hash >> 15;
+
+    return hash & mask;
+}
+
+
+template <typename ElementType>
+unsigned int CuckooHashSet<ElementType>::nextRandom() noexcept
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    return randomState;
+}
+
+
+template <typename ElementType>
+void CuckooHashSet<ElementType>::destroyBuckets(Bucket* table,
+    unsigned int count) noexcept
+{
+    for(unsigned int i = 0; i < count; ++i) {
+
+        for(unsigned int j = 0; j < SLOTS_PER_BUCKET; ++j) {
+
+            if((table[i].occupied & (1u << j)) != 0) {
+
+                table[i].value(j).~ElementType();
+            }
+        }
+    }
+
+    delete[] table;
+}
+
+
+template <typename ElementType>
+void CuckooHashSet<ElementType>::destroyAll() noexcept
+{
+    destroyBuckets(buckets, capacity);
+    stash.clear();
+
+    buckets = nullptr;
+    sz = 0;
+    capacity = 0;
+}
+
+
+template <typename ElementType>
+void CuckooHashSet<ElementType>::copyFrom(const CuckooHashSet& s)
+{
+    if(s.capacity == 0) {
+
+        return;
+    }
+
+    buckets = new Bucket[s.capacity]();
+    capacity = s.capacity;
+
+    try {
+
+        stash = s.stash;
+    }
+    catch(...) {
+
+        destroyAll();
+        throw;
+    }
+
+    sz = static_cast<unsigned int>(stash.size());
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        for(unsigned int j = 0; j < SLOTS_PER_BUCKET; ++j) {
+
+            if((s.buckets[i].occupied & (1u << j)) != 0) {
+
+                try {
+
+                    new (&buckets[i].value(j)) ElementType(s.buckets[i].value(j));
+                }
+                catch(...) {
+
+                    destroyAll();
+                    throw;
+                }
+
+                buckets[i].hashes[j] = s.buckets[i].hashes[j];
+                buckets[i].occupied |= 1u << j;
+                sz++;
+            }
+        }
+    }
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::findSlot(unsigned int hash,
+    const ElementType& element, unsigned int& bucket, unsigned int& slot) const
+{
+    if(capacity == 0) {
+
+        return false;
+    }
+
+    unsigned int mask = capacity - 1;
+    unsigned int candidates[2] = {
+        primaryIndex(hash, mask), alternateIndex(hash, mask) };
+
+    for(unsigned int i = 0; i < 2; ++i) {
+
+        const Bucket& b = buckets[candidates[i]];
+
+        for(unsigned int j = 0; j < SLOTS_PER_BUCKET; ++j) {
+
+            if((b.occupied & (1u << j)) != 0 && b.hashes[j] == hash &&
+                b.value(j) == element) {
+
+                bucket = candidates[i];
+                slot = j;
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+int CuckooHashSet<ElementType>::findStashed(unsigned int hash,
+    const ElementType& element) const
+{
+    for(std::size_t i = 0; i < stash.size(); ++i) {
+
+        if(stash[i].hash == hash && stash[i].value == element) {
+
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::placeInFreeSlot(Bucket& b, unsigned int hash,
+    ElementType& element)
+{
+    for(unsigned int j = 0; j < SLOTS_PER_BUCKET; ++j) {
+
+        if((b.occupied & (1u << j)) == 0) {
+
+            new (&b.value(j)) ElementType(std::move(element));
+            b.hashes[j] = hash;
+            b.occupied |= 1u << j;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// Random-walk displacement bounded by MAX_DISPLACEMENTS. If the walk fails,
+// whichever element was evicted last is appended to overflow. Room for it
+// is reserved before the walk moves anything, so the append cannot run out
+// of memory halfway through.
+template <typename ElementType>
+void CuckooHashSet<ElementType>::place(Bucket* table, unsigned int mask,
+    unsigned int hash, ElementType& element, std::vector<Entry>& overflow)
+{
+    unsigned int bucket = primaryIndex(hash, mask);
+    unsigned int alternate = alternateIndex(hash, mask);
+
+    if(placeInFreeSlot(table[bucket], hash, element) ||
+        placeInFreeSlot(table[alternate], hash, element)) {
+
+        return;
+    }
+
+    if(overflow.size() == overflow.capacity()) {
+
+        overflow.reserve(2 * overflow.size() + 1);
+    }
+
+    if((nextRandom() & 1) != 0) {
+
+        bucket = alternate;
+    }
+
+    for(unsigned int kick = 0; kick < MAX_DISPLACEMENTS; ++kick) {
+
+        Bucket& b = table[bucket];
+        unsigned int slot = nextRandom() % SLOTS_PER_BUCKET;
+
+        std::swap(b.value(slot), element);
+        std::swap(b.hashes[slot], hash);
+
+        unsigned int primary = primaryIndex(hash, mask);
+        bucket = primary != bucket ? primary : alternateIndex(hash, mask);
+
+        if(placeInFreeSlot(table[bucket], hash, element)) {
+
+            return;
+        }
+    }
+
+    overflow.push_back(Entry{ hash, std::move(element) });
+}
+
+
+// Places every element, stashed ones included, into a fresh table of
+// newCapacity buckets and only then swaps it in, so an exception leaves the
+// set as it was. Elements that still cannot be placed form the new stash.
+template <typename ElementType>
+void CuckooHashSet<ElementType>::rehashTo(unsigned int newCapacity)
+{
+    Bucket* fresh = new Bucket[newCapacity]();
+    std::vector<Entry> overflow;
+    unsigned int mask = newCapacity - 1;
+
+    try {
+
+        for(unsigned int i = 0; i < capacity; ++i) {
+
+            for(unsigned int j = 0; j < SLOTS_PER_BUCKET; ++j) {
+
+                if((buckets[i].occupied & (1u << j)) != 0) {
+
+                    ElementType carried(
+                        std::move_if_noexcept(buckets[i].value(j)));
+                    place(fresh, mask, buckets[i].hashes[j], carried, overflow);
+                }
+            }
+        }
+
+        for(Entry& e : stash) {
+
+            ElementType carried(std::move_if_noexcept(e.value));
+            place(fresh, mask, e.hash, carried, overflow);
+        }
+    }
+    catch(...) {
+
+        destroyBuckets(fresh, newCapacity);
+        throw;
+    }
+
+    destroyBuckets(buckets, capacity);
+
+    buckets = fresh;
+    capacity = newCapacity;
+    stash = std::move(overflow);
+}
+
+
+template <typename ElementType>
+template <typename Value>
+bool CuckooHashSet<ElementType>::insert_(Value&& element)
+{
+    unsigned int hash = hashFunction(element);
+    unsigned int bucket = 0;
+    unsigned int slot = 0;
+
+    if(findSlot(hash, element, bucket, slot) || findStashed(hash, element) >= 0) {
+
+        return false;
+    }
+
+    ElementType carried(std::forward<Value>(element));
+
+    if(capacity == 0) {
+
+        buckets = new Bucket[DEFAULT_BUCKET_COUNT]();
+        capacity = DEFAULT_BUCKET_COUNT;
+    }
+
+    std::size_t stashed = stash.size();
+    place(buckets, capacity - 1, hash, carried, stash);
+    sz++;
+
+    // If growing throws, the set keeps its buckets and the stashed element.
+    if(stash.size() > stashed && capacity < MAX_BUCKET_COUNT &&
+        sz - stash.size() >= capacity * SLOTS_PER_BUCKET / 2) {
+
+        rehashTo(capacity * 2);
+    }
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void CuckooHashSet<ElementType>::add(const ElementType& element)
+{
+    insert_(element);
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::insert(const ElementType& element)
+{
+    return insert_(element);
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::insert(ElementType&& element)
+{
+    return insert_(std::move(element));
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::remove(const ElementType& element)
+{
+    unsigned int bucket = 0;
+    unsigned int slot = 0;
+
+    unsigned int hash = hashFunction(element);
+
+    if(!findSlot(hash, element, bucket, slot)) {
+
+        int stashed = findStashed(hash, element);
+
+        if(stashed < 0) {
+
+            return false;
+        }
+
+        std::swap(stash[stashed], stash.back());
+        stash.pop_back();
+        sz--;
+
+        return true;
+    }
+
+    buckets[bucket].value(slot).~ElementType();
+    buckets[bucket].occupied &= ~(1u << slot);
+    sz--;
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool CuckooHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int bucket = 0;
+    unsigned int slot = 0;
+
+    unsigned int hash = hashFunction(element);
+
+    return findSlot(hash, element, bucket, slot) ||
+        findStashed(hash, element) >= 0;
+}
+
+
+template <typename ElementType>
+unsigned int CuckooHashSet<ElementType>::size() const noexcept
+{
+    return sz;
+}
+
+
+template <typename ElementType>
+unsigned int CuckooHashSet<ElementType>::bucketCount() const noexcept
+{
+    return capacity;
+}
+
+
+template <typename ElementType>
+double CuckooHashSet<ElementType>::loadFactor() const noexcept
+{
+    return capacity == 0 ? 0.0 :
+        static_cast<double>(sz) / (capacity * SLOTS_PER_BUCKET);
+}
+
+
+// Sizes for a load factor of 0.9, which 4-way cuckoo tables reach reliably.
+template <typename ElementType>
+void CuckooHashSet<ElementType>::reserve(unsigned int count)
+{
+    unsigned int newCapacity =
+        capacity == 0 ? DEFAULT_BUCKET_COUNT : capacity;
+
+    while(newCapacity < MAX_BUCKET_COUNT &&
+        count > newCapacity * SLOTS_PER_BUCKET * 0.9) {
+
+        newCapacity *= 2;
+    }
+
+    if(newCapacity != capacity) {
+
+        rehashTo(newCapacity);
+    }
+}
+
+#endif // CUCKOO_HASH_SET_HPP
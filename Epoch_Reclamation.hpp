@@ -0,0 +1,246 @@
+// Epoch_Reclamation.hpp
+#ifndef EPOCH_RECLAMATION_HPP
+#define EPOCH_RECLAMATION_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Epoch-based reclamation for lock-free structures. Readers hold a Guard
+// while they may touch shared nodes; writers retire() nodes after unlinking
+// them, and a node is only freed once every guard that could still see it
+// has been released.
+class EpochReclaimer
+{
+public:
+    static constexpr unsigned int MAX_PARTICIPANTS = 128;
+    static constexpr unsigned int RECLAIM_INTERVAL = 64;
+
+    class Guard;
+
+public:
+    EpochReclaimer();
+    ~EpochReclaimer() noexcept;
+
+    EpochReclaimer(const EpochReclaimer& r) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer& r) = delete;
+
+    template <typename T>
+    void retire(T* object);
+    void retire(void* object, void (*deleter)(void*));
+
+    void reclaim();
+
+private:
+    // 0 when free, otherwise the announced epoch shifted left with the low
+    // bit set.
+    struct alignas(64) Participant {
+
+        std::atomic<std::uint64_t> state;
+    };
+
+    struct Retired {
+
+        void* object;
+        void (*deleter)(void*);
+        std::uint64_t epoch;
+        Retired* next;
+    };
+
+    std::atomic<std::uint64_t> globalEpoch;
+    Participant participants[MAX_PARTICIPANTS];
+    std::atomic<Retired*> retired;
+    std::atomic<unsigned int> retiredCount;
+    std::mutex reclaiming;
+
+    unsigned int enter() noexcept;
+    void exit(unsigned int slot) noexcept;
+    bool tryAdvance() noexcept;
+    void pushRetired(Retired* first, Retired* last) noexcept;
+};
+
+
+class EpochReclaimer::Guard
+{
+public:
+    explicit Guard(EpochReclaimer& reclaimer) noexcept;
+    ~Guard() noexcept;
+
+    Guard(const Guard& g) = delete;
+    Guard& operator=(const Guard& g) = delete;
+
+private:
+    EpochReclaimer& reclaimer;
+    unsigned int slot;
+};
+
+
+inline EpochReclaimer::EpochReclaimer()
+    : globalEpoch{ 1 }, retired{ nullptr }, retiredCount{ 0 }
+{
+    for(unsigned int i = 0; i < MAX_PARTICIPANTS; ++i) {
+
+        participants[i].state.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+inline EpochReclaimer::~EpochReclaimer() noexcept
+{
+    Retired* current = retired.exchange(nullptr);
+
+    while(current != nullptr) {
+
+        Retired* next = current->next;
+        current->deleter(current->object);
+        delete current;
+        current = next;
+    }
+}
+
+
+// Spins when every slot is taken, which only happens with more than
+// MAX_PARTICIPANTS guards alive at once.
+inline unsigned int EpochReclaimer::enter() noexcept
+{
+    unsigned int start = static_cast<unsigned int>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    for(unsigned int i = 0; ; ++i) {
+
+        unsigned int slot = (start + i) % MAX_PARTICIPANTS;
+        std::uint64_t expected = 0;
+        std::uint64_t announced = (globalEpoch.load() << 1) | 1;
+
+        if(participants[slot].state.compare_exchange_strong(expected,
+            announced)) {
+
+            return slot;
+        }
+
+        if(i % MAX_PARTICIPANTS == MAX_PARTICIPANTS - 1) {
+
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+inline void EpochReclaimer::exit(unsigned int slot) noexcept
+{
+    participants[slot].state.store(0, std::memory_order_release);
+}
+
+
+inline bool EpochReclaimer::tryAdvance() noexcept
+{
+    std::uint64_t epoch = globalEpoch.load();
+
+    for(unsigned int i = 0; i < MAX_PARTICIPANTS; ++i) {
+
+        std::uint64_t state = participants[i].state.load();
+
+        if(state != 0 && (state >> 1) != epoch) {
+
+            return false;
+        }
+    }
+
+    return globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+
+inline void EpochReclaimer::pushRetired(Retired* first, Retired* last) noexcept
+{
+    Retired* head = retired.load(std::memory_order_relaxed);
+
+    do {
+
+        last->next = head;
+    }
+    while(!retired.compare_exchange_weak(head, first,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+
+template <typename T>
+void EpochReclaimer::retire(T* object)
+{
+    retire(object, [](void* p) { delete static_cast<T*>(p); });
+}
+
+
+inline void EpochReclaimer::retire(void* object, void (*deleter)(void*))
+{
+    Retired* record = new Retired{ object, deleter, globalEpoch.load(), nullptr };
+    pushRetired(record, record);
+
+    if(retiredCount.fetch_add(1) % RECLAIM_INTERVAL == RECLAIM_INTERVAL - 1) {
+
+        reclaim();
+    }
+}
+
+
+// Frees everything retired at least two epochs ago. Only one thread reclaims
+// at a time; the others skip instead of waiting.
+inline void EpochReclaimer::reclaim()
+{
+    std::unique_lock<std::mutex> lock{ reclaiming, std::try_to_lock };
+
+    if(!lock.owns_lock()) {
+
+        return;
+    }
+
+    tryAdvance();
+
+    std::uint64_t epoch = globalEpoch.load();
+    Retired* current = retired.exchange(nullptr, std::memory_order_acquire);
+    Retired* keptFirst = nullptr;
+    Retired* keptLast = nullptr;
+
+    while(current != nullptr) {
+
+        Retired* next = current->next;
+
+        if(current->epoch + 2 <= epoch) {
+
+            current->deleter(current->object);
+            delete current;
+        }
+        else {
+
+            current->next = keptFirst;
+            keptFirst = current;
+
+            if(keptLast == nullptr) {
+
+                keptLast = current;
+            }
+        }
+
+        current = next;
+    }
+
+    if(keptFirst != nullptr) {
+
+        pushRetired(keptFirst, keptLast);
+    }
+}
+
+
+inline EpochReclaimer::Guard::Guard(EpochReclaimer& reclaimer) noexcept
+    : reclaimer{ reclaimer }, slot{ reclaimer.enter() }
+{
+}
+
+
+inline EpochReclaimer::Guard::~Guard() noexcept
+{
+    reclaimer.exit(slot);
+}
+
+#endif // EPOCH_RECLAMATION_HPP
@@ -0,0 +1,470 @@
+// Frozen_Hash_Set.hpp
+#ifndef FROZEN_HASH_SET_HPP
+#define FROZEN_HASH_SET_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Hash_Map.hpp"
+
+// Read-only snapshot of a HashSet built around a minimal perfect hash in
+// the style of PTHash. Keys are split into partitions that are built in
+// parallel. Within a partition every key hashes to a bucket of about
+// KEYS_PER_BUCKET keys, and each bucket stores one 16-bit pilot that sends
+// its keys to distinct free slots, so contains() reads exactly one element.
+//
+// HashFunction only yields 32 bits, so distinct elements may share a hash.
+// The first of them takes the slot and the rest go to a small sorted
+// overflow, which is only searched when the probed slot is flagged.
+template <typename ElementType>
+class FrozenHashSet
+{
+public:
+    static constexpr unsigned int KEYS_PER_BUCKET = 4;
+    static constexpr unsigned int KEYS_PER_PARTITION = 1u << 16;
+    static constexpr unsigned int MAX_PILOT = 0xffff;
+    static constexpr unsigned int MAX_SEED_ATTEMPTS = 16;
+    static constexpr double TABLE_LOAD = 0.99;
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    explicit FrozenHashSet(const HashSet<ElementType>& s,
+        unsigned int threadCount = 0);
+
+    bool contains(const ElementType& element) const;
+    unsigned int size() const noexcept;
+    std::size_t bytesAllocated() const noexcept;
+
+private:
+    struct Partition {
+
+        std::uint64_t seed;
+        unsigned int keyOffset;
+        unsigned int keyCount;
+        unsigned int tableSize;
+        unsigned int bucketCount;
+        unsigned int pilotOffset;
+        unsigned int remapOffset;
+    };
+
+    struct Entry {
+
+        unsigned int hash;
+        const ElementType* element;
+    };
+
+    struct Build {
+
+        std::vector<unsigned short> pilots;
+        std::vector<unsigned int> remap;
+        std::vector<const ElementType*> slots;
+        std::vector<Entry> duplicates;
+        std::uint64_t seed;
+    };
+
+    HashFunction hashFunction;
+    std::vector<Partition> partitions;
+    std::vector<unsigned short> pilots;
+    std::vector<unsigned int> remap;
+    std::vector<ElementType> values;
+    std::vector<bool> collisions;
+    std::vector<unsigned int> overflowHashes;
+    std::vector<ElementType> overflowValues;
+
+    static std::uint64_t mix(std::uint64_t x) noexcept;
+    static std::uint64_t keyHash(unsigned int hash, std::uint64_t seed) noexcept;
+    static unsigned int position(std::uint64_t key, unsigned int pilot,
+        unsigned int tableSize) noexcept;
+
+    unsigned int partitionOf(unsigned int hash) const noexcept;
+    unsigned int slotOf(const Partition& partition,
+        unsigned int hash) const noexcept;
+    static bool buildPartition(std::vector<Entry>& entries, std::uint64_t seed,
+        Build& build);
+};
+
+
+template <typename ElementType>
+FrozenHashSet<ElementType> HashSet<ElementType>::freeze(
+    unsigned int threadCount) const
+{
+    return FrozenHashSet<ElementType>{ *this, threadCount };
+}
+
+
+template <typename ElementType>
+std::uint64_t FrozenHashSet<ElementType>::mix(std::uint64_t x) noexcept
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+
+    return x;
+}
+
+
+template <typename ElementType>
+std::uint64_t FrozenHashSet<ElementType>::keyHash(unsigned int hash,
+    std::uint64_t seed) noexcept
+{
+    return mix(hash * 0x9e3779b97f4a7c15ULL ^ seed);
+}
+
+
+template <typename ElementType>
+unsigned int FrozenHashSet<ElementType>::position(std::uint64_t key,
+    unsigned int pilot, unsigned int tableSize) noexcept
+{
+    return static_cast<unsigned int>(mix(key ^ mix(pilot + 1)) % tableSize);
+}
+
+
+template <typename ElementType>
+unsigned int FrozenHashSet<ElementType>::partitionOf(
+    unsigned int hash) const noexcept
+{
+    std::uint64_t spread = mix(hash) >> 32;
+
+    return static_cast<unsigned int>((spread * partitions.size()) >> 32);
+}
+
+
+template <typename ElementType>
+unsigned int FrozenHashSet<ElementType>::slotOf(const Partition& partition,
+    unsigned int hash) const noexcept
+{
+    std::uint64_t key = keyHash(hash, partition.seed);
+    unsigned int bucket = static_cast<unsigned int>(
+        (key >> 32) % partition.bucketCount);
+    unsigned int slot = position(key, pilots[partition.pilotOffset + bucket],
+        partition.tableSize);
+
+    if(slot >= partition.keyCount) {
+
+        slot = remap[partition.remapOffset + slot - partition.keyCount];
+    }
+
+    return partition.keyOffset + slot;
+}
+
+
+// Places one partition's distinct hashes, largest buckets first, trying
+// pilots until all keys of a bucket land on distinct free slots. Slots past
+// keyCount are then remapped onto the free slots below it, which makes the
+// function minimal. Fails if some bucket exhausts MAX_PILOT.
+template <typename ElementType>
+bool FrozenHashSet<ElementType>::buildPartition(std::vector<Entry>& entries,
+    std::uint64_t seed, Build& build)
+{
+    unsigned int keyCount = static_cast<unsigned int>(entries.size());
+    unsigned int tableSize = std::max(keyCount,
+        static_cast<unsigned int>(keyCount / TABLE_LOAD));
+    unsigned int bucketCount = std::max(1u, keyCount / KEYS_PER_BUCKET);
+
+    std::vector<std::uint64_t> keys(keyCount);
+    std::vector<unsigned int> bucketStart(bucketCount + 1, 0);
+
+    for(unsigned int i = 0; i < keyCount; ++i) {
+
+        keys[i] = keyHash(entries[i].hash, seed);
+        bucketStart[(keys[i] >> 32) % bucketCount + 1]++;
+    }
+
+    for(unsigned int b = 0; b < bucketCount; ++b) {
+
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    std::vector<unsigned int> members(keyCount);
+    std::vector<unsigned int> fill(bucketStart.begin(), bucketStart.end() - 1);
+
+    for(unsigned int i = 0; i < keyCount; ++i) {
+
+        members[fill[(keys[i] >> 32) % bucketCount]++] = i;
+    }
+
+    std::vector<unsigned int> order(bucketCount);
+    for(unsigned int b = 0; b < bucketCount; ++b) {
+
+        order[b] = b;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+        [&](unsigned int a, unsigned int b) {
+
+            return bucketStart[a + 1] - bucketStart[a] >
+                bucketStart[b + 1] - bucketStart[b];
+        });
+
+    std::vector<bool> taken(tableSize, false);
+    std::vector<unsigned int> placed(keyCount);
+    build.pilots.assign(bucketCount, 0);
+
+    for(unsigned int b : order) {
+
+        unsigned int first = bucketStart[b];
+        unsigned int last = bucketStart[b + 1];
+        bool found = false;
+
+        for(unsigned int pilot = 0; pilot <= MAX_PILOT && !found; ++pilot) {
+
+            found = true;
+
+            for(unsigned int i = first; i < last && found; ++i) {
+
+                unsigned int slot = position(keys[members[i]], pilot, tableSize);
+
+                if(taken[slot]) {
+
+                    found = false;
+                }
+
+                for(unsigned int j = first; j < i && found; ++j) {
+
+                    found = placed[members[j]] != slot;
+                }
+
+                placed[members[i]] = slot;
+            }
+
+            if(found) {
+
+                build.pilots[b] = static_cast<unsigned short>(pilot);
+
+                for(unsigned int i = first; i < last; ++i) {
+
+                    taken[placed[members[i]]] = true;
+                }
+            }
+        }
+
+        if(!found) {
+
+            return false;
+        }
+    }
+
+    build.remap.assign(tableSize - keyCount, 0);
+    unsigned int freeSlot = 0;
+
+    for(unsigned int slot = keyCount; slot < tableSize; ++slot) {
+
+        if(taken[slot]) {
+
+            while(taken[freeSlot]) {
+
+                freeSlot++;
+            }
+
+            build.remap[slot - keyCount] = freeSlot++;
+        }
+    }
+
+    build.slots.assign(keyCount, nullptr);
+    for(unsigned int i = 0; i < keyCount; ++i) {
+
+        unsigned int slot = placed[i];
+
+        if(slot >= keyCount) {
+
+            slot = build.remap[slot - keyCount];
+        }
+
+        build.slots[slot] = entries[i].element;
+    }
+
+    build.seed = seed;
+
+    return true;
+}
+
+
+template <typename ElementType>
+FrozenHashSet<ElementType>::FrozenHashSet(const HashSet<ElementType>& s,
+    unsigned int threadCount)
+    : hashFunction{ s.hasher() }
+{
+    std::vector<Entry> entries;
+    entries.reserve(s.size());
+
+    for(const ElementType& element : s) {
+
+        entries.push_back(Entry{ 0, &element });
+    }
+
+    unsigned int count = static_cast<unsigned int>(entries.size());
+    unsigned int chunk = KEYS_PER_PARTITION;
+
+    impl_::HashTable__runParallel((count + chunk - 1) / chunk, threadCount,
+        [&](unsigned int c) {
+
+        unsigned int last = std::min(count, (c + 1) * chunk);
+
+        for(unsigned int i = c * chunk; i < last; ++i) {
+
+            entries[i].hash = hashFunction(*entries[i].element);
+        }
+    });
+
+    partitions.resize(std::max(1u, (count + chunk - 1) / chunk));
+
+    std::vector<std::vector<Entry>> partitioned(partitions.size());
+    for(const Entry& entry : entries) {
+
+        partitioned[partitionOf(entry.hash)].push_back(entry);
+    }
+
+    std::vector<Build> builds(partitions.size());
+
+    impl_::HashTable__runParallel(
+        static_cast<unsigned int>(partitions.size()), threadCount,
+        [&](unsigned int p) {
+
+        std::vector<Entry>& group = partitioned[p];
+        std::sort(group.begin(), group.end(),
+            [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+        std::vector<Entry> distinct;
+        distinct.reserve(group.size());
+
+        for(const Entry& entry : group) {
+
+            if(!distinct.empty() && distinct.back().hash == entry.hash) {
+
+                builds[p].duplicates.push_back(entry);
+            }
+            else {
+
+                distinct.push_back(entry);
+            }
+        }
+
+        std::uint64_t seed = mix(p + 1);
+        unsigned int attempt = 0;
+
+        while(!buildPartition(distinct, seed, builds[p])) {
+
+            if(++attempt == MAX_SEED_ATTEMPTS) {
+
+                throw std::runtime_error{ "Could not build a perfect hash!" };
+            }
+
+            seed = mix(seed);
+        }
+    });
+
+    std::size_t keyTotal = 0;
+    for(unsigned int p = 0; p < partitions.size(); ++p) {
+
+        Build& build = builds[p];
+        Partition& partition = partitions[p];
+
+        partition.seed = build.seed;
+        partition.keyOffset = static_cast<unsigned int>(keyTotal);
+        partition.keyCount = static_cast<unsigned int>(build.slots.size());
+        partition.tableSize = partition.keyCount +
+            static_cast<unsigned int>(build.remap.size());
+        partition.bucketCount = static_cast<unsigned int>(build.pilots.size());
+        partition.pilotOffset = static_cast<unsigned int>(pilots.size());
+        partition.remapOffset = static_cast<unsigned int>(remap.size());
+
+        pilots.insert(pilots.end(), build.pilots.begin(), build.pilots.end());
+        remap.insert(remap.end(), build.remap.begin(), build.remap.end());
+        keyTotal += build.slots.size();
+    }
+
+    values.reserve(keyTotal);
+    std::vector<Entry> duplicates;
+
+    for(Build& build : builds) {
+
+        for(const ElementType* element : build.slots) {
+
+            values.push_back(*element);
+        }
+
+        duplicates.insert(duplicates.end(), build.duplicates.begin(),
+            build.duplicates.end());
+    }
+
+    if(!duplicates.empty()) {
+
+        std::sort(duplicates.begin(), duplicates.end(),
+            [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+        collisions.assign(values.size(), false);
+
+        for(const Entry& entry : duplicates) {
+
+            const Partition& partition = partitions[partitionOf(entry.hash)];
+
+            collisions[slotOf(partition, entry.hash)] = true;
+            overflowHashes.push_back(entry.hash);
+            overflowValues.push_back(*entry.element);
+        }
+    }
+}
+
+
+template <typename ElementType>
+bool FrozenHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int hash = hashFunction(element);
+    const Partition& partition = partitions[partitionOf(hash)];
+
+    if(partition.keyCount == 0) {
+
+        return false;
+    }
+
+    unsigned int slot = slotOf(partition, hash);
+
+    if(values[slot] == element) {
+
+        return true;
+    }
+
+    if(collisions.empty() || !collisions[slot]) {
+
+        return false;
+    }
+
+    auto first = std::lower_bound(overflowHashes.begin(), overflowHashes.end(),
+        hash);
+
+    for(auto i = first; i != overflowHashes.end() && *i == hash; ++i) {
+
+        if(overflowValues[i - overflowHashes.begin()] == element) {
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+unsigned int FrozenHashSet<ElementType>::size() const noexcept
+{
+    return static_cast<unsigned int>(values.size() + overflowValues.size());
+}
+
+
+template <typename ElementType>
+std::size_t FrozenHashSet<ElementType>::bytesAllocated() const noexcept
+{
+    return sizeof(Partition) * partitions.size() +
+        sizeof(unsigned short) * pilots.size() +
+        sizeof(unsigned int) * remap.size() +
+        sizeof(ElementType) * values.size() +
+        collisions.size() / 8 +
+        sizeof(unsigned int) * overflowHashes.size() +
+        sizeof(ElementType) * overflowValues.size();
+}
+
+#endif // FROZEN_HASH_SET_HPP
@@ -2,19 +2,47 @@
 #ifndef HASH_MAP_HPP
 #define HASH_MAP_HPP
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Bloom_Filter.hpp"
+#include "Hash_Table.hpp"
 #include "Set.hpp"
 #include "StringHashing.hpp"
 
+template <typename ElementType>
+class FrozenHashSet;
+
+
 template <typename ElementType>
 class HashSet : public Set<ElementType>
 {
+private:
+    using Table = impl_::HashTable<ElementType,
+        impl_::HashTable__identity<ElementType>>;
+
 public:
-    static constexpr unsigned int DEFAULT_CAPACITY = 10;
+    static constexpr unsigned int DEFAULT_CAPACITY = Table::DEFAULT_CAPACITY;
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR =
+        Table::DEFAULT_MAX_LOAD_FACTOR;
+    static constexpr unsigned int BATCH_GROUP_SIZE = 32;
+    static constexpr double DEFAULT_FILTER_FALSE_POSITIVE_RATE = 0.01;
+    static constexpr unsigned int BUCKETS_PER_TASK = Table::BUCKETS_PER_TASK;
+
+    // Up to this many elements are kept inside the set object itself, so
+    // small sets allocate nothing. While a set is that small, remove() and
+    // moving the set move its elements, and the insert that outgrows the
+    // inline room moves them into the table.
+    static constexpr unsigned int INLINE_CAPACITY = Table::INLINE_CAPACITY;
     using HashFunction = std::function<unsigned int(const ElementType&)>;
+    using ConstIterator = typename Table::ConstIterator;
 
 public:
-    explicit HashSet(HashFunction hashFunction);
+    explicit HashSet(HashFunction hashFunction,
+        const HashSetMemoryOptions& memory = HashSetMemoryOptions{});
     ~HashSet() noexcept override;
 
     HashSet(const HashSet& s);
@@ -25,31 +53,172 @@ public:
 
     bool isImplemented() const noexcept override;
     void add(const ElementType& element) override;
+    std::pair<ConstIterator, bool> insert(const ElementType& element);
+    std::pair<ConstIterator, bool> insert(ElementType&& element);
+
+    template <typename... Args>
+    std::pair<ConstIterator, bool> emplace(Args&&... args);
+
+    bool remove(const ElementType& element);
+
+    template <typename Predicate>
+    unsigned int removeIf(Predicate predicate);
+
     bool contains(const ElementType& element) const override;
+    std::vector<bool> containsBatch(const std::vector<ElementType>& elements) const;
+    unsigned int addBatch(const std::vector<ElementType>& elements);
     unsigned int size() const noexcept override;
     unsigned int elementsAtIndex(unsigned int index) const;
     bool isElementAtIndex(const ElementType& element, unsigned int index) const;
 
+    ConstIterator begin() const noexcept;
+    ConstIterator end() const noexcept;
+
+    // Both call visitor(const ElementType&) once per element in bucket order.
+    // forEachParallel hands out runs of BUCKETS_PER_TASK buckets to
+    // threadCount threads (all cores by default), so its visitor must be
+    // safe to call concurrently.
+    template <typename Visitor>
+    void forEach(Visitor visitor) const;
+
+    template <typename Visitor>
+    void forEachParallel(Visitor visitor, unsigned int threadCount = 0) const;
+
+    // Moves the elements of other that are missing here by relinking their
+    // nodes; elements already present stay in other.
+    unsigned int merge(HashSet& other);
+    unsigned int merge(HashSet&& other);
+
+    // Results use a's hash function and memory options and are sized up
+    // front, then filled in parallel by hash range on threadCount threads.
+    static HashSet setUnion(const HashSet& a, const HashSet& b,
+        unsigned int threadCount = 0);
+    static HashSet setIntersection(const HashSet& a, const HashSet& b,
+        unsigned int threadCount = 0);
+    static HashSet setDifference(const HashSet& a, const HashSet& b,
+        unsigned int threadCount = 0);
+
+    double loadFactor() const;
+    double maxLoadFactor() const noexcept;
+    void maxLoadFactor(double factor);
+    unsigned int bucketCount() const noexcept;
+
+    void reserve(unsigned int count);
+    void rehash(unsigned int buckets);
+    void shrinkToFit();
+
+    // An enabled filter answers most misses of contains() without touching
+    // the table. Removed elements keep their bits until the filter is next
+    // rebuilt, which happens once it has seen as many inserts as it was
+    // sized for.
+    void enableFilter(
+        double falsePositiveRate = DEFAULT_FILTER_FALSE_POSITIVE_RATE);
+    void disableFilter() noexcept;
+    bool filterEnabled() const noexcept;
+
+    HashSetStatistics statistics() const;
+    HashFunction hasher() const;
+    const HashSetMemoryOptions& memoryOptions() const noexcept;
+
+    // Samples chain lengths to tell whether the hash function spreads the
+    // current elements evenly. With checking on, this is done right away,
+    // whenever an insert brings the size to a power of two, and after every
+    // merge(), all once the set holds at least 1024 elements. The sets that
+    // setUnion(), setIntersection() and setDifference() return start with
+    // checking off. Mixing rescues hashes that differ in bits the bucket
+    // count ignores, but not distinct elements that hash alike: under
+    // impl_::HashSet__undefinedHashFunction every lookup still walks one
+    // chain, and only the handler can report it.
+    HashSetHashQuality hashQuality() const;
+    void checkHashes(HashSetHashCheck check,
+        HashSetPoorHashHandler handler = nullptr);
+
+    // Defined in Frozen_Hash_Set.hpp.
+    FrozenHashSet<ElementType> freeze(unsigned int threadCount = 0) const;
+
+private:
+    static constexpr unsigned int MIN_FILTER_CAPACITY = 1024;
+
+    Table table;
+    std::unique_ptr<BlockedBloomFilter> filter;
+    unsigned int filterInserts;
+
+    void filterInsert(unsigned int hash);
+    void rebuildFilter(double falsePositiveRate);
+};
+
+
+// Key-value map on the same chained table as HashSet. Entries are stored
+// inline in the nodes, so lookups hand out references rather than copies.
+template <typename KeyType, typename ValueType>
+class HashMap
+{
 private:
-    HashFunction hashFunction;
-    
-    struct Node {
+    using Table = impl_::HashTable<std::pair<const KeyType, ValueType>,
+        impl_::HashTable__first<KeyType, ValueType>>;
+
+public:
+    using HashFunction = std::function<unsigned int(const KeyType&)>;
+    using Entry = std::pair<const KeyType, ValueType>;
+    using Iterator = typename Table::Iterator;
+    using ConstIterator = typename Table::ConstIterator;
+
+public:
+    explicit HashMap(HashFunction hashFunction);
+    ~HashMap() noexcept;
+
+    HashMap(const HashMap& m);
+    HashMap(HashMap&& m) noexcept;
+
+    HashMap& operator=(const HashMap& m);
+    HashMap& operator=(HashMap&& m) noexcept;
+
+    Iterator find(const KeyType& key);
+    ConstIterator find(const KeyType& key) const;
+    bool contains(const KeyType& key) const;
 
-        ElementType value;
-        Node* next;
-    };
+    ValueType& operator[](const KeyType& key);
+    ValueType& operator[](KeyType&& key);
 
-    Node** hashTable;
-    unsigned int sz, capacity;
+    template <typename... Args>
+    std::pair<Iterator, bool> tryEmplace(const KeyType& key, Args&&... args);
+
+    template <typename... Args>
+    std::pair<Iterator, bool> tryEmplace(KeyType&& key, Args&&... args);
+
+    template <typename Value>
+    std::pair<Iterator, bool> insertOrAssign(const KeyType& key, Value&& value);
+
+    template <typename Value>
+    std::pair<Iterator, bool> insertOrAssign(KeyType&& key, Value&& value);
+
+    bool remove(const KeyType& key);
+
+    template <typename Predicate>
+    unsigned int removeIf(Predicate predicate);
+
+    unsigned int size() const noexcept;
+
+    Iterator begin() noexcept;
+    Iterator end() noexcept;
+    ConstIterator begin() const noexcept;
+    ConstIterator end() const noexcept;
 
     double loadFactor() const;
-    void destroyAll() noexcept;
+    double maxLoadFactor() const noexcept;
+    void maxLoadFactor(double factor);
+    unsigned int bucketCount() const noexcept;
+
+    void reserve(unsigned int count);
+    void rehash(unsigned int buckets);
+    void shrinkToFit();
+
+    HashSetStatistics statistics() const;
+
+private:
+    Table table;
 };
 
-namespace {
-    
-    unsigned int max_bucketCount = 0;
-}
 
 namespace impl_
 {
@@ -62,105 +231,33 @@ namespace impl_
 
 
 template <typename ElementType>
-HashSet<ElementType>::HashSet(HashFunction hashFunction)
-    : hashFunction{ hashFunction },
-      hashTable{ nullptr }, sz{ 0 }, capacity{ DEFAULT_CAPACITY }
+HashSet<ElementType>::HashSet(HashFunction hashFunction,
+    const HashSetMemoryOptions& memory)
+    : table{ hashFunction, memory }, filterInserts{ 0 }
 {
-    hashTable = new Node*[DEFAULT_CAPACITY];
-    this->hashFunction = hashFunction;
-
-    for(unsigned int i = 0; i < capacity; ++i) {
-        
-        hashTable[i] = nullptr;
-    }
 }
 
 
 template <typename ElementType>
 HashSet<ElementType>::~HashSet() noexcept
 {
-    if(hashTable != nullptr) {
-    
-        for(unsigned int i = 0; i < capacity; ++i) {
-
-            Node* head = hashTable[i];
-            Node* current = head;
-
-            while(current != nullptr) {
-            
-                head = current;
-                current = current->next;
-                delete head;
-            }
-        }
-    }
-    
-    delete[] hashTable;
 }
 
 
 template <typename ElementType>
 HashSet<ElementType>::HashSet(const HashSet& s)
-    : hashFunction{s.hashFunction},
-      hashTable{ nullptr }, sz{ s.sz }, capacity{ s.capacity }
-{
-    Node** newhashTable = new Node*[capacity];
-    for(unsigned int i = 0; i < s.capacity; ++i) {
-        
-        Node* originalHash = s.hashTable[i];
-        Node* newHash = nullptr;
-
-        try {
-            
-            while(originalHash != nullptr) {
-                
-                newHash = new Node{originalHash->value, newHash};
-                originalHash = originalHash->next;
-            }
-            
-            newhashTable[i] = newHash;
-        }
-        catch(...) {
-            
-            destroyAll();
-            throw;
-        }
-    }
-    
-    hashTable = newhashTable;
-}
-
-
-template <typename ElementType>
-HashSet<ElementType>::HashSet(HashSet&& s) noexcept
-    : hashFunction{ s.hashFunction },
-      hashTable{ nullptr }, sz{ 0 }, capacity{ DEFAULT_CAPACITY }
+    : table{ s.table },
+      filter{ s.filter ? new BlockedBloomFilter{ *s.filter } : nullptr },
+      filterInserts{ s.filterInserts }
 {
-    std::swap(hashTable, s.hashTable);
-    std::swap(sz, s.sz);
-    std::swap(capacity, s.capacity);
 }
 
 
 template <typename ElementType>
-void HashSet<ElementType>::destroyAll() noexcept
+HashSet<ElementType>::HashSet(HashSet&& s) noexcept
+    : table{ std::move(s.table) }, filter{ std::move(s.filter) },
+      filterInserts{ s.filterInserts }
 {
-    for(unsigned int i = 0; i < capacity; ++i) {
-
-        Node* head = hashTable[i];
-        Node* current = head;
-
-        while(current != nullptr) {
-            
-            head = current;
-            current = current->next;
-            delete head;
-            sz--;
-        }
-
-        hashTable[i] = nullptr;
-        max_bucketCount = 0;
-    }
 }
 
 
@@ -168,37 +265,13 @@ template <typename ElementType>
 HashSet<ElementType>& HashSet<ElementType>::operator=(const HashSet& s)
 {
     if(this != &s) {
-        
-        destroyAll();
-
-        Node** newHashTable = new Node*[s.capacity];
-        for(unsigned int i = 0; i < s.capacity; ++i) {
-        
-            Node* originalHash = s.hashTable[i];
-            Node* newHash = nullptr;
-
-            try {
-            
-                while(originalHash != nullptr) {
-                
-                    newHash = new Node{originalHash->value, newHash};
-                    originalHash = originalHash->next;
-                }
-            
-                newHashTable[i] = newHash;
-            }
-            catch(...) {
-            
-                destroyAll();
-                throw;
-            }
-        }
-        
-        sz = s.sz;
-        capacity = s.capacity;
-        
-        delete[] hashTable;
-        hashTable = newHashTable;
+
+        std::unique_ptr<BlockedBloomFilter> copy{ s.filter ?
+            new BlockedBloomFilter{ *s.filter } : nullptr };
+
+        table = s.table;
+        filter = std::move(copy);
+        filterInserts = s.filterInserts;
     }
 
     return *this;
@@ -209,10 +282,10 @@ template <typename ElementType>
 HashSet<ElementType>& HashSet<ElementType>::operator=(HashSet&& s) noexcept
 {
     if(this != &s) {
-        
-        std::swap(hashTable, s.hashTable);
-        std::swap(sz, s.sz);
-        std::swap(capacity, s.capacity);
+
+        table = std::move(s.table);
+        filter = std::move(s.filter);
+        filterInserts = s.filterInserts;
     }
 
     return *this;
@@ -229,145 +302,691 @@ bool HashSet<ElementType>::isImplemented() const noexcept
 template <typename ElementType>
 double HashSet<ElementType>::loadFactor() const {
 
-    return static_cast<double>(sz) / capacity;
+    return table.loadFactor();
+}
+
+
+template <typename ElementType>
+double HashSet<ElementType>::maxLoadFactor() const noexcept
+{
+    return table.maxLoadFactor();
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::maxLoadFactor(double factor)
+{
+    table.maxLoadFactor(factor);
+}
+
+
+template <typename ElementType>
+unsigned int HashSet<ElementType>::bucketCount() const noexcept
+{
+    return table.bucketCount();
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::reserve(unsigned int count)
+{
+    table.reserve(count);
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::rehash(unsigned int buckets)
+{
+    table.rehash(buckets);
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::shrinkToFit()
+{
+    table.shrinkToFit();
 }
 
 
 template <typename ElementType>
 void HashSet<ElementType>::add(const ElementType& element)
 {
-    
-    if(loadFactor() > 0.8) {
-        
-        unsigned int newCapacity = capacity * 2 + 1;
-        Node** newHashTable = new Node*[newCapacity]();
+    insert(element);
+}
 
-        for(unsigned int i = 0; i < capacity; ++i) {
-            
-            Node* head = hashTable[i];
-            while(head != nullptr) {
-                
-                Node* current = head;
-                head = head->next;
 
-                unsigned int index = hashFunction(element) % newCapacity;
+template <typename ElementType>
+std::pair<typename HashSet<ElementType>::ConstIterator, bool>
+    HashSet<ElementType>::insert(const ElementType& element)
+{
+    unsigned int hash = table.hash(element);
+    auto result = table.emplace(hash, element, element);
 
-                Node*& newHash = newHashTable[index];
+    if(result.second) {
 
-                current->next = newHash;
-                newHash = current;
-            }
-        }
-        
-        capacity = newCapacity;
-        
-        delete[] hashTable;
-        hashTable = newHashTable;
+        filterInsert(hash);
     }
 
-    unsigned int index = hashFunction(element) % capacity;
-    
-    if(contains(element) == false) {
-        
-        Node* head = hashTable[index];
-        Node* current = head;
+    return result;
+}
 
-        if(head == nullptr) {
-            
-            current = new Node;
-            current->value = element;
-            current->next = nullptr;
 
-            hashTable[index] = current;
-        }
-        else {
-            
-            current = new Node;
-            current->value = element;
+template <typename ElementType>
+std::pair<typename HashSet<ElementType>::ConstIterator, bool>
+    HashSet<ElementType>::insert(ElementType&& element)
+{
+    unsigned int hash = table.hash(element);
+    auto result = table.emplace(hash, element, std::move(element));
 
-            current->next = head;
-            hashTable[index] = current;
-        }
+    if(result.second) {
 
-        sz++;
+        filterInsert(hash);
     }
+
+    return result;
 }
 
 
+// Builds the element from args in its node and destroys it again if an
+// equal element is already present.
 template <typename ElementType>
-bool HashSet<ElementType>::contains(const ElementType& element) const
+template <typename... Args>
+std::pair<typename HashSet<ElementType>::ConstIterator, bool>
+    HashSet<ElementType>::emplace(Args&&... args)
+{
+    unsigned int hash = 0;
+    auto result = table.emplaceValue(hash, std::forward<Args>(args)...);
+
+    if(result.second) {
+
+        filterInsert(hash);
+    }
+
+    return result;
+}
+
+
+template <typename ElementType>
+bool HashSet<ElementType>::remove(const ElementType& element)
+{
+    return table.remove(element);
+}
+
+
+template <typename ElementType>
+template <typename Predicate>
+unsigned int HashSet<ElementType>::removeIf(Predicate predicate)
+{
+    return table.removeIf(predicate);
+}
+
+
+template <typename ElementType>
+std::vector<bool> HashSet<ElementType>::containsBatch(
+    const std::vector<ElementType>& elements) const
+{
+    std::vector<bool> results(elements.size());
+    unsigned int hashes[BATCH_GROUP_SIZE];
+
+    for(std::size_t first = 0; first < elements.size();
+        first += BATCH_GROUP_SIZE) {
+
+        unsigned int count = static_cast<unsigned int>(
+            std::min<std::size_t>(BATCH_GROUP_SIZE, elements.size() - first));
+
+        table.prefetch(&elements[first], count, hashes);
+
+        for(unsigned int i = 0; i < count; ++i) {
+
+            results[first + i] =
+                (!filter || filter->mayContain(hashes[i])) &&
+                table.containsHashed(hashes[i], elements[first + i]);
+        }
+    }
+
+    return results;
+}
+
+
+// The table is grown up front so that no resize moves the buckets that were
+// prefetched for a group.
+template <typename ElementType>
+unsigned int HashSet<ElementType>::addBatch(
+    const std::vector<ElementType>& elements)
 {
-    
-    unsigned int index = hashFunction(element) % capacity;
+    table.reserve(table.size() + static_cast<unsigned int>(elements.size()));
+
+    unsigned int added = 0;
+    unsigned int hashes[BATCH_GROUP_SIZE];
+
+    for(std::size_t first = 0; first < elements.size();
+        first += BATCH_GROUP_SIZE) {
+
+        unsigned int count = static_cast<unsigned int>(
+            std::min<std::size_t>(BATCH_GROUP_SIZE, elements.size() - first));
 
-    Node* find = hashTable[index];
+        table.prefetch(&elements[first], count, hashes);
 
-    while(find != nullptr) {
+        for(unsigned int i = 0; i < count; ++i) {
 
-        if(find->value == element) {
-            
-            return true;
+            const ElementType& element = elements[first + i];
+
+            if(table.emplace(hashes[i], element, element).second) {
+
+                filterInsert(hashes[i]);
+                added++;
+            }
         }
+    }
+
+    return added;
+}
+
 
-        find = find->next;
+template <typename ElementType>
+bool HashSet<ElementType>::contains(const ElementType& element) const
+{
+    if(!filter) {
+
+        return table.contains(element);
     }
-    
-    return false;
+
+    unsigned int hash = table.hash(element);
+
+    return filter->mayContain(hash) && table.containsHashed(hash, element);
 }
 
 
 template <typename ElementType>
 unsigned int HashSet<ElementType>::size() const noexcept
 {
-    return sz;
+    return table.size();
 }
 
 
 template <typename ElementType>
 unsigned int HashSet<ElementType>::elementsAtIndex(unsigned int index) const
 {
-    if(index >= 0 && index < capacity) {
-    
-        unsigned int temp = 0;
-        Node* current = hashTable[index];
+    return table.elementsAtIndex(index);
+}
 
-        while(current != nullptr) {
-        
-            temp++;
-            current = current->next;
-        }
 
-        return temp;
+template <typename ElementType>
+bool HashSet<ElementType>::isElementAtIndex(const ElementType& element,
+    unsigned int index) const
+{
+    return table.isKeyAtIndex(element, index);
+}
+
+
+template <typename ElementType>
+typename HashSet<ElementType>::ConstIterator
+    HashSet<ElementType>::begin() const noexcept
+{
+    return table.begin();
+}
+
+
+template <typename ElementType>
+typename HashSet<ElementType>::ConstIterator
+    HashSet<ElementType>::end() const noexcept
+{
+    return table.end();
+}
+
+
+template <typename ElementType>
+template <typename Visitor>
+void HashSet<ElementType>::forEach(Visitor visitor) const
+{
+    table.forEachInBuckets(0, table.bucketCount(), visitor);
+}
+
+
+template <typename ElementType>
+template <typename Visitor>
+void HashSet<ElementType>::forEachParallel(Visitor visitor,
+    unsigned int threadCount) const
+{
+    unsigned int buckets = table.bucketCount();
+    unsigned int tasks = (buckets + BUCKETS_PER_TASK - 1) / BUCKETS_PER_TASK;
+
+    impl_::HashTable__runParallel(tasks, threadCount, [&](unsigned int task) {
+
+        table.forEachInBuckets(task * BUCKETS_PER_TASK,
+            (task + 1) * BUCKETS_PER_TASK, visitor);
+    });
+}
+
+
+template <typename ElementType>
+unsigned int HashSet<ElementType>::merge(HashSet& other)
+{
+    return table.merge(other.table, [this](unsigned int hash) {
+
+        filterInsert(hash);
+    });
+}
+
+
+template <typename ElementType>
+unsigned int HashSet<ElementType>::merge(HashSet&& other)
+{
+    return merge(other);
+}
+
+
+template <typename ElementType>
+HashSet<ElementType> HashSet<ElementType>::setUnion(const HashSet& a,
+    const HashSet& b, unsigned int threadCount)
+{
+    HashSet result{ a.hasher(), a.table.memoryOptions() };
+    const Table* sources[] = { &a.table, &b.table };
+
+    result.table.buildParallel(sources, 2,
+        [](const ElementType&) { return true; },
+        a.size() + b.size(), threadCount);
+
+    return result;
+}
+
+
+// Scans the smaller set and probes the larger one.
+template <typename ElementType>
+HashSet<ElementType> HashSet<ElementType>::setIntersection(const HashSet& a,
+    const HashSet& b, unsigned int threadCount)
+{
+    const HashSet& smaller = a.size() <= b.size() ? a : b;
+    const HashSet& larger = a.size() <= b.size() ? b : a;
+
+    HashSet result{ a.hasher(), a.table.memoryOptions() };
+    const Table* sources[] = { &smaller.table };
+
+    result.table.buildParallel(sources, 1,
+        [&larger](const ElementType& element) {
+
+            return larger.table.contains(element);
+        },
+        smaller.size(), threadCount);
+
+    return result;
+}
+
+
+template <typename ElementType>
+HashSet<ElementType> HashSet<ElementType>::setDifference(const HashSet& a,
+    const HashSet& b, unsigned int threadCount)
+{
+    HashSet result{ a.hasher(), a.table.memoryOptions() };
+    const Table* sources[] = { &a.table };
+
+    result.table.buildParallel(sources, 1,
+        [&b](const ElementType& element) {
+
+            return !b.table.contains(element);
+        },
+        a.size(), threadCount);
+
+    return result;
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::enableFilter(double falsePositiveRate)
+{
+    rebuildFilter(falsePositiveRate);
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::disableFilter() noexcept
+{
+    filter.reset();
+    filterInserts = 0;
+}
+
+
+template <typename ElementType>
+bool HashSet<ElementType>::filterEnabled() const noexcept
+{
+    return filter != nullptr;
+}
+
+
+// Sized for twice the current elements, so rebuilds are amortized over the
+// inserts in between just like table resizes. The old filter is kept until
+// the new one is complete.
+template <typename ElementType>
+void HashSet<ElementType>::rebuildFilter(double falsePositiveRate)
+{
+    unsigned int capacity = std::max(MIN_FILTER_CAPACITY, table.size() * 2);
+    std::unique_ptr<BlockedBloomFilter> rebuilt{
+        new BlockedBloomFilter{ capacity, falsePositiveRate } };
+
+    for(const ElementType& element : table) {
+
+        rebuilt->add(table.hash(element));
     }
-    else {
-        
-        return 0;
+
+    filter = std::move(rebuilt);
+    filterInserts = table.size();
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::filterInsert(unsigned int hash)
+{
+    if(!filter) {
+
+        return;
+    }
+
+    filter->add(hash);
+
+    if(++filterInserts > filter->capacity()) {
+
+        rebuildFilter(filter->falsePositiveRate());
     }
 }
 
 
 template <typename ElementType>
-bool HashSet<ElementType>::isElementAtIndex(const ElementType& element, 
-    unsigned int index) const
+HashSetStatistics HashSet<ElementType>::statistics() const
 {
-    if(index >= 0 || index < capacity) {
-        
-        Node* current = hashTable[index];
-        
-        while(current != nullptr) {
-        
-            if(current->value == element) {
-                
-                return true;
-            }
-            else {
-                
-                current = current->next;
-            }
-        }        
+    HashSetStatistics result = table.statistics();
+
+    if(filter) {
+
+        result.bytesAllocated += filter->bytesAllocated();
+    }
+
+    return result;
+}
+
+
+template <typename ElementType>
+typename HashSet<ElementType>::HashFunction HashSet<ElementType>::hasher() const
+{
+    return table.hasher();
+}
+
+
+template <typename ElementType>
+const HashSetMemoryOptions& HashSet<ElementType>::memoryOptions() const noexcept
+{
+    return table.memoryOptions();
+}
+
+
+template <typename ElementType>
+HashSetHashQuality HashSet<ElementType>::hashQuality() const
+{
+    return table.hashQuality();
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::checkHashes(HashSetHashCheck check,
+    HashSetPoorHashHandler handler)
+{
+    table.checkHashes(check, std::move(handler));
+}
+
+
+template <typename KeyType, typename ValueType>
+HashMap<KeyType, ValueType>::HashMap(HashFunction hashFunction)
+    : table{ hashFunction }
+{
+}
+
+
+template <typename KeyType, typename ValueType>
+HashMap<KeyType, ValueType>::~HashMap() noexcept
+{
+}
+
+
+template <typename KeyType, typename ValueType>
+HashMap<KeyType, ValueType>::HashMap(const HashMap& m)
+    : table{ m.table }
+{
+}
+
+
+template <typename KeyType, typename ValueType>
+HashMap<KeyType, ValueType>::HashMap(HashMap&& m) noexcept
+    : table{ std::move(m.table) }
+{
+}
+
+
+template <typename KeyType, typename ValueType>
+HashMap<KeyType, ValueType>& HashMap<KeyType, ValueType>::operator=(
+    const HashMap& m)
+{
+    if(this != &m) {
+
+        table = m.table;
     }
-    
-    return false;
+
+    return *this;
+}
+
+
+template <typename KeyType, typename ValueType>
+HashMap<KeyType, ValueType>& HashMap<KeyType, ValueType>::operator=(
+    HashMap&& m) noexcept
+{
+    if(this != &m) {
+
+        table = std::move(m.table);
+    }
+
+    return *this;
+}
+
+
+template <typename KeyType, typename ValueType>
+typename HashMap<KeyType, ValueType>::Iterator
+    HashMap<KeyType, ValueType>::find(const KeyType& key)
+{
+    return table.find(key);
+}
+
+
+template <typename KeyType, typename ValueType>
+typename HashMap<KeyType, ValueType>::ConstIterator
+    HashMap<KeyType, ValueType>::find(const KeyType& key) const
+{
+    return table.find(key);
+}
+
+
+template <typename KeyType, typename ValueType>
+bool HashMap<KeyType, ValueType>::contains(const KeyType& key) const
+{
+    return table.contains(key);
+}
+
+
+template <typename KeyType, typename ValueType>
+ValueType& HashMap<KeyType, ValueType>::operator[](const KeyType& key)
+{
+    return tryEmplace(key).first->second;
+}
+
+
+template <typename KeyType, typename ValueType>
+ValueType& HashMap<KeyType, ValueType>::operator[](KeyType&& key)
+{
+    return tryEmplace(std::move(key)).first->second;
+}
+
+
+// The value is only constructed from args when key is not already present.
+template <typename KeyType, typename ValueType>
+template <typename... Args>
+std::pair<typename HashMap<KeyType, ValueType>::Iterator, bool>
+    HashMap<KeyType, ValueType>::tryEmplace(const KeyType& key, Args&&... args)
+{
+    return table.emplace(table.hash(key), key, std::piecewise_construct,
+        std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+
+template <typename KeyType, typename ValueType>
+template <typename... Args>
+std::pair<typename HashMap<KeyType, ValueType>::Iterator, bool>
+    HashMap<KeyType, ValueType>::tryEmplace(KeyType&& key, Args&&... args)
+{
+    return table.emplace(table.hash(key), key, std::piecewise_construct,
+        std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+
+template <typename KeyType, typename ValueType>
+template <typename Value>
+std::pair<typename HashMap<KeyType, ValueType>::Iterator, bool>
+    HashMap<KeyType, ValueType>::insertOrAssign(const KeyType& key,
+    Value&& value)
+{
+    std::pair<Iterator, bool> result = tryEmplace(key, std::forward<Value>(value));
+
+    if(!result.second) {
+
+        result.first->second = std::forward<Value>(value);
+    }
+
+    return result;
+}
+
+
+template <typename KeyType, typename ValueType>
+template <typename Value>
+std::pair<typename HashMap<KeyType, ValueType>::Iterator, bool>
+    HashMap<KeyType, ValueType>::insertOrAssign(KeyType&& key, Value&& value)
+{
+    std::pair<Iterator, bool> result =
+        tryEmplace(std::move(key), std::forward<Value>(value));
+
+    if(!result.second) {
+
+        result.first->second = std::forward<Value>(value);
+    }
+
+    return result;
+}
+
+
+template <typename KeyType, typename ValueType>
+bool HashMap<KeyType, ValueType>::remove(const KeyType& key)
+{
+    return table.remove(key);
+}
+
+
+template <typename KeyType, typename ValueType>
+template <typename Predicate>
+unsigned int HashMap<KeyType, ValueType>::removeIf(Predicate predicate)
+{
+    return table.removeIf(predicate);
+}
+
+
+template <typename KeyType, typename ValueType>
+unsigned int HashMap<KeyType, ValueType>::size() const noexcept
+{
+    return table.size();
+}
+
+
+template <typename KeyType, typename ValueType>
+typename HashMap<KeyType, ValueType>::Iterator
+    HashMap<KeyType, ValueType>::begin() noexcept
+{
+    return table.begin();
+}
+
+
+template <typename KeyType, typename ValueType>
+typename HashMap<KeyType, ValueType>::Iterator
+    HashMap<KeyType, ValueType>::end() noexcept
+{
+    return table.end();
+}
+
+
+template <typename KeyType, typename ValueType>
+typename HashMap<KeyType, ValueType>::ConstIterator
+    HashMap<KeyType, ValueType>::begin() const noexcept
+{
+    return table.begin();
+}
+
+
+template <typename KeyType, typename ValueType>
+typename HashMap<KeyType, ValueType>::ConstIterator
+    HashMap<KeyType, ValueType>::end() const noexcept
+{
+    return table.end();
+}
+
+
+template <typename KeyType, typename ValueType>
+double HashMap<KeyType, ValueType>::loadFactor() const
+{
+    return table.loadFactor();
+}
+
+
+template <typename KeyType, typename ValueType>
+double HashMap<KeyType, ValueType>::maxLoadFactor() const noexcept
+{
+    return table.maxLoadFactor();
+}
+
+
+template <typename KeyType, typename ValueType>
+void HashMap<KeyType, ValueType>::maxLoadFactor(double factor)
+{
+    table.maxLoadFactor(factor);
+}
+
+
+template <typename KeyType, typename ValueType>
+unsigned int HashMap<KeyType, ValueType>::bucketCount() const noexcept
+{
+    return table.bucketCount();
+}
+
+
+template <typename KeyType, typename ValueType>
+void HashMap<KeyType, ValueType>::reserve(unsigned int count)
+{
+    table.reserve(count);
+}
+
+
+template <typename KeyType, typename ValueType>
+void HashMap<KeyType, ValueType>::rehash(unsigned int buckets)
+{
+    table.rehash(buckets);
+}
+
+
+template <typename KeyType, typename ValueType>
+void HashMap<KeyType, ValueType>::shrinkToFit()
+{
+    table.shrinkToFit();
+}
+
+
+template <typename KeyType, typename ValueType>
+HashSetStatistics HashMap<KeyType, ValueType>::statistics() const
+{
+    return table.statistics();
 }
 
 #endif // HASH_MAP_HPP
@@ -0,0 +1,325 @@
+// Hash_Multiset.hpp
+#ifndef HASH_MULTISET_HPP
+#define HASH_MULTISET_HPP
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Hash_Table.hpp"
+
+// Counts occurrences of elements on the same chained table as HashSet. The
+// count lives in the element's node, so recording an occurrence costs one
+// hash and one bucket walk whether or not the element was seen before.
+// size() is the number of distinct elements and total() the number of
+// occurrences.
+template <typename ElementType>
+class HashMultiset
+{
+private:
+    using Table = impl_::HashTable<std::pair<const ElementType,
+        unsigned long long>, impl_::HashTable__first<ElementType,
+        unsigned long long>>;
+
+public:
+    static constexpr unsigned int BATCH_GROUP_SIZE = 32;
+    using HashFunction = std::function<unsigned int(const ElementType&)>;
+    using Entry = std::pair<const ElementType, unsigned long long>;
+    using ConstIterator = typename Table::ConstIterator;
+
+public:
+    explicit HashMultiset(HashFunction hashFunction);
+    ~HashMultiset() noexcept;
+
+    HashMultiset(const HashMultiset& m);
+    HashMultiset(HashMultiset&& m) noexcept;
+
+    HashMultiset& operator=(const HashMultiset& m);
+    HashMultiset& operator=(HashMultiset&& m) noexcept;
+
+    unsigned long long increment(const ElementType& element,
+        unsigned long long by = 1);
+    void incrementBatch(const std::vector<ElementType>& elements);
+    unsigned long long decrement(const ElementType& element,
+        unsigned long long by = 1);
+    bool remove(const ElementType& element);
+
+    unsigned long long count(const ElementType& element) const;
+    bool contains(const ElementType& element) const;
+
+    // The k most frequent elements with their counts, most frequent first.
+    // Elements with equal counts come in no particular order.
+    std::vector<std::pair<ElementType, unsigned long long>> topK(
+        unsigned int k) const;
+
+    unsigned int size() const noexcept;
+    unsigned long long total() const noexcept;
+
+    ConstIterator begin() const noexcept;
+    ConstIterator end() const noexcept;
+
+    void reserve(unsigned int count);
+    HashSetStatistics statistics() const;
+
+private:
+    Table table;
+    unsigned long long totalCount;
+};
+
+
+template <typename ElementType>
+HashMultiset<ElementType>::HashMultiset(HashFunction hashFunction)
+    : table{ hashFunction }, totalCount{ 0 }
+{
+}
+
+
+template <typename ElementType>
+HashMultiset<ElementType>::~HashMultiset() noexcept
+{
+}
+
+
+template <typename ElementType>
+HashMultiset<ElementType>::HashMultiset(const HashMultiset& m)
+    : table{ m.table }, totalCount{ m.totalCount }
+{
+}
+
+
+template <typename ElementType>
+HashMultiset<ElementType>::HashMultiset(HashMultiset&& m) noexcept
+    : table{ std::move(m.table) }, totalCount{ m.totalCount }
+{
+    m.totalCount = 0;
+}
+
+
+template <typename ElementType>
+HashMultiset<ElementType>& HashMultiset<ElementType>::operator=(
+    const HashMultiset& m)
+{
+    if(this != &m) {
+
+        table = m.table;
+        totalCount = m.totalCount;
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+HashMultiset<ElementType>& HashMultiset<ElementType>::operator=(
+    HashMultiset&& m) noexcept
+{
+    if(this != &m) {
+
+        table = std::move(m.table);
+        totalCount = m.totalCount;
+        m.totalCount = 0;
+    }
+
+    return *this;
+}
+
+
+// Returns the element's count after adding by.
+template <typename ElementType>
+unsigned long long HashMultiset<ElementType>::increment(
+    const ElementType& element, unsigned long long by)
+{
+    auto result = table.emplace(table.hash(element), element,
+        std::piecewise_construct, std::forward_as_tuple(element),
+        std::forward_as_tuple(0));
+
+    result.first->second += by;
+    totalCount += by;
+
+    return result.first->second;
+}
+
+
+// Hashes and prefetches the buckets of BATCH_GROUP_SIZE elements at a time
+// before counting them. Unlike HashSet::addBatch the table is not grown for
+// the whole batch up front, since a batch of events usually repeats keys.
+template <typename ElementType>
+void HashMultiset<ElementType>::incrementBatch(
+    const std::vector<ElementType>& elements)
+{
+    unsigned int hashes[BATCH_GROUP_SIZE];
+
+    for(std::size_t first = 0; first < elements.size();
+        first += BATCH_GROUP_SIZE) {
+
+        unsigned int count = static_cast<unsigned int>(
+            std::min<std::size_t>(BATCH_GROUP_SIZE, elements.size() - first));
+
+        table.prefetch(&elements[first], count, hashes);
+
+        for(unsigned int i = 0; i < count; ++i) {
+
+            const ElementType& element = elements[first + i];
+
+            table.emplace(hashes[i], element, std::piecewise_construct,
+                std::forward_as_tuple(element),
+                std::forward_as_tuple(0)).first->second++;
+        }
+    }
+
+    totalCount += elements.size();
+}
+
+
+// Returns the element's count after taking away by, removing the element
+// once its count reaches zero.
+template <typename ElementType>
+unsigned long long HashMultiset<ElementType>::decrement(
+    const ElementType& element, unsigned long long by)
+{
+    unsigned int hash = table.hash(element);
+    auto found = table.findHashed(hash, element);
+
+    if(found == table.end()) {
+
+        return 0;
+    }
+
+    if(found->second > by) {
+
+        found->second -= by;
+        totalCount -= by;
+
+        return found->second;
+    }
+
+    totalCount -= found->second;
+    table.removeHashed(hash, element);
+
+    return 0;
+}
+
+
+template <typename ElementType>
+bool HashMultiset<ElementType>::remove(const ElementType& element)
+{
+    unsigned int hash = table.hash(element);
+    auto found = table.findHashed(hash, element);
+
+    if(found == table.end()) {
+
+        return false;
+    }
+
+    totalCount -= found->second;
+
+    return table.removeHashed(hash, element);
+}
+
+
+template <typename ElementType>
+unsigned long long HashMultiset<ElementType>::count(
+    const ElementType& element) const
+{
+    auto found = table.find(element);
+
+    return found == table.end() ? 0 : found->second;
+}
+
+
+template <typename ElementType>
+bool HashMultiset<ElementType>::contains(const ElementType& element) const
+{
+    return table.contains(element);
+}
+
+
+// Keeps the k largest counts seen so far in a min-heap of entry pointers,
+// so a scan costs O(n log k) and only the winners are copied out.
+template <typename ElementType>
+std::vector<std::pair<ElementType, unsigned long long>>
+    HashMultiset<ElementType>::topK(unsigned int k) const
+{
+    std::vector<const Entry*> heap;
+    heap.reserve(std::min(k, table.size()));
+
+    auto moreFrequent = [](const Entry* a, const Entry* b) {
+
+        return a->second > b->second;
+    };
+
+    auto offer = [&](const Entry& entry) {
+
+        if(heap.size() < k) {
+
+            heap.push_back(&entry);
+            std::push_heap(heap.begin(), heap.end(), moreFrequent);
+        }
+        else if(k > 0 && entry.second > heap.front()->second) {
+
+            std::pop_heap(heap.begin(), heap.end(), moreFrequent);
+            heap.back() = &entry;
+            std::push_heap(heap.begin(), heap.end(), moreFrequent);
+        }
+    };
+
+    table.forEachInBuckets(0, table.bucketCount(), offer);
+    std::sort_heap(heap.begin(), heap.end(), moreFrequent);
+
+    std::vector<std::pair<ElementType, unsigned long long>> top;
+    top.reserve(heap.size());
+
+    for(const Entry* entry : heap) {
+
+        top.emplace_back(entry->first, entry->second);
+    }
+
+    return top;
+}
+
+
+template <typename ElementType>
+unsigned int HashMultiset<ElementType>::size() const noexcept
+{
+    return table.size();
+}
+
+
+template <typename ElementType>
+unsigned long long HashMultiset<ElementType>::total() const noexcept
+{
+    return totalCount;
+}
+
+
+template <typename ElementType>
+typename HashMultiset<ElementType>::ConstIterator
+    HashMultiset<ElementType>::begin() const noexcept
+{
+    return table.begin();
+}
+
+
+template <typename ElementType>
+typename HashMultiset<ElementType>::ConstIterator
+    HashMultiset<ElementType>::end() const noexcept
+{
+    return table.end();
+}
+
+
+template <typename ElementType>
+void HashMultiset<ElementType>::reserve(unsigned int count)
+{
+    table.reserve(count);
+}
+
+
+template <typename ElementType>
+HashSetStatistics HashMultiset<ElementType>::statistics() const
+{
+    return table.statistics();
+}
+
+#endif // HASH_MULTISET_HPP
@@ -0,0 +1,107 @@
+// Hash_Set_Filter_Benchmark.hpp
+#ifndef HASH_SET_FILTER_BENCHMARK_HPP
+#define HASH_SET_FILTER_BENCHMARK_HPP
+
+#include <vector>
+#include "Hash_Map.hpp"
+#include "Hash_Set_Profile.hpp"
+
+// Lookup profiles of one set with and without its Bloom filter, for one
+// share of lookups that hit. Both runs look up the same keys in the same
+// order, so their hits agree.
+struct HashSetFilterProfile
+{
+    double hitRatio;
+    HashSetLookupProfile plain;
+    HashSetLookupProfile filtered;
+};
+
+
+namespace impl_
+{
+    // lookupCount keys of which about hitRatio are drawn from elements and
+    // the rest from absentKeys, in a fixed pseudo-random order.
+    template <typename ElementType>
+    std::vector<ElementType> HashSetFilterBenchmark__keys(
+        const std::vector<ElementType>& elements,
+        const std::vector<ElementType>& absentKeys, double hitRatio,
+        unsigned int lookupCount)
+    {
+        std::vector<ElementType> keys;
+        keys.reserve(lookupCount);
+
+        unsigned int hitThreshold =
+            static_cast<unsigned int>(hitRatio * 0xffffffffu);
+        unsigned int state = 0x9e3779b9u;
+
+        auto next = [&state]() {
+
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return state;
+        };
+
+        for(unsigned int i = 0; i < lookupCount; ++i) {
+
+            const std::vector<ElementType>& source =
+                next() < hitThreshold ? elements : absentKeys;
+
+            keys.push_back(source[next() % source.size()]);
+        }
+
+        return keys;
+    }
+}
+
+
+// Builds one set of elements and, for each entry of hitRatios, profiles
+// lookupCount lookups first with the filter off and then with it enabled
+// at falsePositiveRate. absentKeys must not occur in elements. The filter
+// pays off at low hit ratios and costs time at high ones; where it crosses
+// over depends on how expensive the element type is to compare.
+template <typename ElementType>
+std::vector<HashSetFilterProfile> compareFilterHitRatios(
+    const std::vector<ElementType>& elements,
+    const std::vector<ElementType>& absentKeys,
+    typename HashSet<ElementType>::HashFunction hashFunction,
+    const std::vector<double>& hitRatios,
+    unsigned int lookupCount = 1u << 20,
+    double falsePositiveRate =
+        HashSet<ElementType>::DEFAULT_FILTER_FALSE_POSITIVE_RATE,
+    unsigned int rounds = 1)
+{
+    std::vector<HashSetFilterProfile> profiles;
+
+    if(elements.empty() || absentKeys.empty()) {
+
+        return profiles;
+    }
+
+    HashSet<ElementType> s{ hashFunction };
+    s.addBatch(elements);
+
+    for(double hitRatio : hitRatios) {
+
+        std::vector<ElementType> keys = impl_::HashSetFilterBenchmark__keys(
+            elements, absentKeys, hitRatio, lookupCount);
+
+        HashSetFilterProfile profile;
+        profile.hitRatio = hitRatio;
+
+        s.disableFilter();
+        profile.plain = profileLookups(s, keys, rounds);
+
+        s.enableFilter(falsePositiveRate);
+        profile.filtered = profileLookups(s, keys, rounds);
+
+        profiles.push_back(profile);
+    }
+
+    s.disableFilter();
+
+    return profiles;
+}
+
+#endif // HASH_SET_FILTER_BENCHMARK_HPP
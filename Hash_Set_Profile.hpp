@@ -0,0 +1,203 @@
+// Hash_Set_Profile.hpp
+#ifndef HASH_SET_PROFILE_HPP
+#define HASH_SET_PROFILE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Hash_Map.hpp"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HASH_SET_PROFILE_PERF_EVENTS
+#endif
+#endif
+
+// Result of profiling a run of lookups. hits counts the lookups that found
+// their key. The miss counts come from the CPU's performance counters
+// through perf_event_open and are per lookup; they read zero and
+// countersAvailable is false when the kernel does not allow counting, as is
+// common in containers and virtual machines.
+struct HashSetLookupProfile
+{
+    HashSetMemoryOptions memory;
+    double nanosecondsPerLookup;
+    double tlbMissesPerLookup;
+    double cacheMissesPerLookup;
+    unsigned long long hits;
+    bool countersAvailable;
+};
+
+
+namespace impl_
+{
+    // One hardware counter of the calling thread, user space only.
+    class HashSetProfile__counter
+    {
+    public:
+        explicit HashSetProfile__counter(std::uint32_t type,
+            std::uint64_t config) noexcept;
+        ~HashSetProfile__counter() noexcept;
+
+        HashSetProfile__counter(const HashSetProfile__counter& c) = delete;
+        HashSetProfile__counter& operator=(
+            const HashSetProfile__counter& c) = delete;
+
+        bool isAvailable() const noexcept;
+        void start() noexcept;
+        std::uint64_t stop() noexcept;
+
+    private:
+        int fd;
+    };
+
+
+    inline HashSetProfile__counter::HashSetProfile__counter(std::uint32_t type,
+        std::uint64_t config) noexcept
+        : fd{ -1 }
+    {
+#ifdef HASH_SET_PROFILE_PERF_EVENTS
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        fd = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0,
+            -1, -1, 0));
+#else
+        static_cast<void>(type);
+        static_cast<void>(config);
+#endif
+    }
+
+
+    inline HashSetProfile__counter::~HashSetProfile__counter() noexcept
+    {
+#ifdef HASH_SET_PROFILE_PERF_EVENTS
+        if(fd >= 0) {
+
+            ::close(fd);
+        }
+#endif
+    }
+
+
+    inline bool HashSetProfile__counter::isAvailable() const noexcept
+    {
+        return fd >= 0;
+    }
+
+
+    inline void HashSetProfile__counter::start() noexcept
+    {
+#ifdef HASH_SET_PROFILE_PERF_EVENTS
+        if(fd >= 0) {
+
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+
+    inline std::uint64_t HashSetProfile__counter::stop() noexcept
+    {
+        std::uint64_t count = 0;
+
+#ifdef HASH_SET_PROFILE_PERF_EVENTS
+        if(fd >= 0) {
+
+            ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            if(::read(fd, &count, sizeof(count)) != sizeof(count)) {
+
+                count = 0;
+            }
+        }
+#endif
+
+        return count;
+    }
+}
+
+
+// Looks up every key of keys in s, rounds times over, and reports the time
+// and the data-TLB and last-level cache misses per lookup.
+template <typename ElementType>
+HashSetLookupProfile profileLookups(const HashSet<ElementType>& s,
+    const std::vector<ElementType>& keys, unsigned int rounds = 1)
+{
+#ifdef HASH_SET_PROFILE_PERF_EVENTS
+    impl_::HashSetProfile__counter tlbMisses{ PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+    impl_::HashSetProfile__counter cacheMisses{ PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_CACHE_MISSES };
+#else
+    impl_::HashSetProfile__counter tlbMisses{ 0, 0 };
+    impl_::HashSetProfile__counter cacheMisses{ 0, 0 };
+#endif
+
+    HashSetLookupProfile profile;
+    profile.memory = s.memoryOptions();
+    profile.hits = 0;
+
+    tlbMisses.start();
+    cacheMisses.start();
+    auto started = std::chrono::steady_clock::now();
+
+    for(unsigned int round = 0; round < rounds; ++round) {
+
+        for(const ElementType& key : keys) {
+
+            profile.hits += s.contains(key);
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    double lookups = std::max(1.0, static_cast<double>(keys.size()) * rounds);
+
+    profile.tlbMissesPerLookup = tlbMisses.stop() / lookups;
+    profile.cacheMissesPerLookup = cacheMisses.stop() / lookups;
+    profile.countersAvailable = tlbMisses.isAvailable() &&
+        cacheMisses.isAvailable();
+    profile.nanosecondsPerLookup =
+        std::chrono::duration<double, std::nano>(elapsed).count() / lookups;
+
+    return profile;
+}
+
+
+// Builds a set of elements under each of the given memory options and
+// profiles the same lookups in each, so their TLB and cache behaviour can
+// be compared side by side. Only one of the sets is alive at a time.
+template <typename ElementType>
+std::vector<HashSetLookupProfile> compareMemoryOptions(
+    const std::vector<ElementType>& elements,
+    const std::vector<ElementType>& keys,
+    typename HashSet<ElementType>::HashFunction hashFunction,
+    const std::vector<HashSetMemoryOptions>& options, unsigned int rounds = 1)
+{
+    std::vector<HashSetLookupProfile> profiles;
+
+    for(const HashSetMemoryOptions& memory : options) {
+
+        HashSet<ElementType> s{ hashFunction, memory };
+        s.addBatch(elements);
+        profiles.push_back(profileLookups(s, keys, rounds));
+    }
+
+    return profiles;
+}
+
+#endif // HASH_SET_PROFILE_HPP
@@ -0,0 +1,2413 @@
+// Hash_Table.hpp
+#ifndef HASH_TABLE_HPP
+#define HASH_TABLE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef HASH_SET_STATISTICS
+#include <chrono>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Snapshot returned by HashSet::statistics(). chainLengthHistogram[k] is the
+// number of buckets holding k elements. The lookup and resize counters are
+// only maintained when HASH_SET_STATISTICS is defined and read zero otherwise.
+struct HashSetStatistics
+{
+    std::vector<unsigned int> chainLengthHistogram;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long hitProbes;
+    unsigned long long missProbes;
+    unsigned int resizeCount;
+    double resizeSeconds;
+    std::size_t bytesAllocated;
+
+    double averageProbesPerHit() const noexcept;
+    double averageProbesPerMiss() const noexcept;
+};
+
+
+// Result of HashSet::hashQuality(). Up to SAMPLE_BUCKETS buckets are
+// compared against the Poisson chain lengths a uniform hash would give, and
+// deviation is how many standard deviations the chi-square statistic of
+// the sample lies above its expectation. Past POOR_DEVIATION the hash
+// function is clustering keys.
+struct HashSetHashQuality
+{
+    static constexpr unsigned int SAMPLE_BUCKETS = 1024;
+    static constexpr double POOR_DEVIATION = 5.0;
+
+    unsigned int sampledBuckets;
+    unsigned int longestChain;
+    double chiSquare;
+    double deviation;
+    bool mixing;
+
+    bool isPoor() const noexcept;
+};
+
+
+// What a HashSet does when a hash check finds its hash clustering keys.
+// Checks run when checking is enabled, when an insert brings the size to a
+// power of two at or above HASH_CHECK_MIN_SIZE, and after merge() and
+// buildParallel(). WARN calls the handler. MIX passes hashes through the
+// MurmurHash3 finalizer before taking the bucket from then on, and only
+// calls the handler if keys still cluster afterwards, as they do when
+// distinct keys share one hash.
+enum class HashSetHashCheck { OFF, WARN, MIX };
+
+using HashSetPoorHashHandler = std::function<void(const HashSetHashQuality&)>;
+
+
+// Where a HashSet puts its bucket array and node slabs. With any option
+// set, allocations of at least HUGE_PAGE_BYTES / 2 are mapped directly,
+// rounded up to whole huge pages and aligned to one, and node slabs grow
+// to a full huge page. Smaller allocations come from operator new.
+//
+// TRANSPARENT_HUGE asks for transparent huge pages with madvise, and
+// EXPLICIT_HUGE maps from the reserved hugetlbfs pool, falling back to
+// transparent ones when the pool is empty. INTERLEAVE spreads pages over
+// all NUMA nodes and PREFERRED_NODE places them on node when it has room.
+// Every option is a hint, and memory the kernel refuses it for is still
+// allocated without it. Outside Linux the options are ignored.
+struct HashSetMemoryOptions
+{
+    enum class Pages { DEFAULT, TRANSPARENT_HUGE, EXPLICIT_HUGE };
+    enum class Placement { DEFAULT, INTERLEAVE, PREFERRED_NODE };
+
+    static constexpr std::size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+    Pages pages = Pages::DEFAULT;
+    Placement placement = Placement::DEFAULT;
+    unsigned int node = 0;
+
+    bool isDefault() const noexcept;
+};
+
+
+namespace impl_
+{
+    inline void HashSet__prefetch(const void* address) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#endif
+    }
+
+
+    // Runs function(i) for every i below count on threadCount threads, the
+    // calling one included, handing out indices in order. The first
+    // exception thrown stops the remaining work and is rethrown here. If
+    // the system refuses to start some of the threads, the work runs on
+    // fewer.
+    template <typename Function>
+    void HashTable__runParallel(unsigned int count, unsigned int threadCount,
+        Function function)
+    {
+        if(threadCount == 0) {
+
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        std::atomic<unsigned int> next{ 0 };
+        std::atomic<bool> failed{ false };
+        std::exception_ptr failure;
+
+        auto worker = [&]() {
+
+            try {
+
+                for(unsigned int i = next++; i < count && !failed; i = next++) {
+
+                    function(i);
+                }
+            }
+            catch(...) {
+
+                if(!failed.exchange(true)) {
+
+                    failure = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+
+        try {
+
+            for(unsigned int i = 1; i < std::min(threadCount, count); ++i) {
+
+                threads.emplace_back(worker);
+            }
+        }
+        catch(...) {
+
+            // Out of threads or memory for them. The tasks are handed out
+            // on demand, so the threads already running and this one still
+            // finish all of them.
+        }
+
+        worker();
+
+        for(std::thread& thread : threads) {
+
+            thread.join();
+        }
+
+        if(failure) {
+
+            std::rethrow_exception(failure);
+        }
+    }
+
+
+    inline bool HashTable__isMapped(std::size_t bytes,
+        const HashSetMemoryOptions& memory) noexcept
+    {
+#ifdef __linux__
+        return !memory.isDefault() &&
+            bytes >= HashSetMemoryOptions::HUGE_PAGE_BYTES / 2;
+#else
+        static_cast<void>(bytes);
+        static_cast<void>(memory);
+
+        return false;
+#endif
+    }
+
+
+    // MurmurHash3's 32-bit finalizer. Every input bit affects every output
+    // bit, so hashes differing only in bits the modulus ignores still spread.
+    // The other hash containers share it for the same reason.
+    constexpr unsigned int HashTable__mix(unsigned int hash) noexcept
+    {
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+
+        return hash;
+    }
+
+
+    // Shard of a sharded container. It comes from the high bits of the
+    // mixed hash, so the low bits each shard's table indexes with stay
+    // evenly spread within the shard. mask is the shard count minus one.
+    constexpr unsigned int HashTable__shardIndex(unsigned int hash,
+        unsigned int mask) noexcept
+    {
+        return (HashTable__mix(hash) >> 16) & mask;
+    }
+
+
+    inline std::size_t HashTable__mappedLength(std::size_t bytes) noexcept
+    {
+        const std::size_t page = HashSetMemoryOptions::HUGE_PAGE_BYTES;
+
+        return (bytes + page - 1) / page * page;
+    }
+
+
+    // Memory for bytes bytes, placed as memory asks. Mapped regions come
+    // zero-filled, and are over-allocated by one huge page and trimmed so
+    // that they start on a huge page boundary.
+    inline void* HashTable__allocate(std::size_t bytes,
+        const HashSetMemoryOptions& memory)
+    {
+        if(!HashTable__isMapped(bytes, memory)) {
+
+            return ::operator new(bytes);
+        }
+
+#ifdef __linux__
+        using Options = HashSetMemoryOptions;
+
+        const std::size_t page = Options::HUGE_PAGE_BYTES;
+        std::size_t length = HashTable__mappedLength(bytes);
+        void* block = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        if(memory.pages == Options::Pages::EXPLICIT_HUGE) {
+
+            block = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+#endif
+
+        if(block == MAP_FAILED) {
+
+            char* raw = static_cast<char*>(::mmap(nullptr, length + page,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+            if(raw == MAP_FAILED) {
+
+                throw std::bad_alloc{};
+            }
+
+            std::size_t head = (page - reinterpret_cast<std::uintptr_t>(raw) %
+                page) % page;
+
+            if(head > 0) {
+
+                ::munmap(raw, head);
+            }
+
+            ::munmap(raw + head + length, page - head);
+            block = raw + head;
+
+#ifdef MADV_HUGEPAGE
+            if(memory.pages != Options::Pages::DEFAULT) {
+
+                ::madvise(block, length, MADV_HUGEPAGE);
+            }
+#endif
+        }
+
+#ifdef SYS_mbind
+        if(memory.placement != Options::Placement::DEFAULT) {
+
+            const int preferred = 1;
+            const int interleave = 3;
+            unsigned long nodes = memory.placement ==
+                Options::Placement::INTERLEAVE ? ~0UL :
+                1UL << (memory.node % (8 * sizeof(unsigned long)));
+
+            ::syscall(SYS_mbind, block, length,
+                memory.placement == Options::Placement::INTERLEAVE ?
+                interleave : preferred, &nodes, 8 * sizeof(nodes) + 1, 0);
+        }
+#endif
+
+        return block;
+#else
+        throw std::bad_alloc{};
+#endif
+    }
+
+
+    inline void HashTable__deallocate(void* block, std::size_t bytes,
+        const HashSetMemoryOptions& memory) noexcept
+    {
+        if(block == nullptr) {
+
+            return;
+        }
+
+#ifdef __linux__
+        if(HashTable__isMapped(bytes, memory)) {
+
+            ::munmap(block, HashTable__mappedLength(bytes));
+
+            return;
+        }
+#endif
+
+        ::operator delete(block);
+    }
+
+
+    // Slab allocator for the chain nodes of one table. Slabs grow
+    // geometrically up to MAX_SLAB_BYTES and are carved front to back, so
+    // nodes created one after another sit next to each other in memory.
+    // Released nodes go on a free list that later allocations take first.
+    // Slabs are only given back when the pool itself is destroyed, which
+    // costs one delete per slab however many nodes were handed out. With
+    // memory options set, slabs grow to a full huge page instead.
+    template <typename NodeType>
+    class HashTable__NodePool
+    {
+    public:
+        static constexpr std::size_t MIN_SLAB_NODES = 16;
+        static constexpr std::size_t MAX_SLAB_BYTES = 1 << 20;
+
+    public:
+        explicit HashTable__NodePool(
+            const HashSetMemoryOptions& memory = HashSetMemoryOptions{})
+            noexcept;
+        ~HashTable__NodePool() noexcept;
+
+        HashTable__NodePool(const HashTable__NodePool& p) = delete;
+        HashTable__NodePool& operator=(const HashTable__NodePool& p) = delete;
+
+        void* allocate();
+        void deallocate(void* node) noexcept;
+        // other must have been created with the same memory options.
+        void absorb(HashTable__NodePool& other);
+
+        std::size_t bytesAllocated() const noexcept;
+
+    private:
+        union Slot {
+
+            Slot* next;
+            alignas(NodeType) unsigned char storage[sizeof(NodeType)];
+        };
+
+        struct Slab {
+
+            Slot* slots;
+            std::size_t bytes;
+        };
+
+        HashSetMemoryOptions memory;
+        std::vector<Slab> slabs;
+        Slot* freeList;
+        Slot* cursor;
+        std::size_t remaining;
+        std::size_t slabNodes;
+        std::size_t bytes;
+    };
+
+
+    // Room for Count nodes inside the table object. Their hashes are kept in
+    // an array of their own, so a lookup scans one or two cache lines of
+    // hashes and only compares the keys whose hash matches.
+    template <typename NodeType, unsigned int Count>
+    struct HashTable__inlineNodes
+    {
+        NodeType* node(unsigned int index) const noexcept
+        {
+            return reinterpret_cast<NodeType*>(
+                const_cast<unsigned char*>(storage[index]));
+        }
+
+        unsigned int hashes[Count];
+        alignas(NodeType) unsigned char storage[Count][sizeof(NodeType)];
+    };
+
+
+    // A table without inline capacity is only inline while it is empty, so
+    // node() and hashes are never used.
+    template <typename NodeType>
+    struct HashTable__inlineNodes<NodeType, 0>
+    {
+        NodeType* node(unsigned int) const noexcept
+        {
+            return nullptr;
+        }
+
+        unsigned int hashes[1];
+    };
+
+
+    // Small element types that move without throwing get up to 16 elements
+    // stored inline, as many as fit in about 256 bytes but at least 4.
+    template <typename ElementType>
+    constexpr unsigned int HashTable__inlineCapacity() noexcept
+    {
+        return !std::is_nothrow_move_constructible<ElementType>::value ? 0 :
+            256 / (sizeof(ElementType) + sizeof(void*)) > 16 ? 16 :
+            256 / (sizeof(ElementType) + sizeof(void*)) < 4 ? 4 :
+            256 / (sizeof(ElementType) + sizeof(void*));
+    }
+
+
+    template <typename ElementType>
+    struct HashTable__identity
+    {
+        using KeyType = ElementType;
+
+        static constexpr unsigned int INLINE_CAPACITY =
+            HashTable__inlineCapacity<ElementType>();
+
+        static const KeyType& key(const ElementType& element) noexcept
+        {
+            return element;
+        }
+    };
+
+
+    // Map entries are never stored inline: HashMap hands out references to
+    // them that have to survive later inserts.
+    template <typename KeyType_, typename MappedType>
+    struct HashTable__first
+    {
+        using KeyType = KeyType_;
+
+        static constexpr unsigned int INLINE_CAPACITY = 0;
+
+        static const KeyType& key(
+            const std::pair<const KeyType, MappedType>& entry) noexcept
+        {
+            return entry.first;
+        }
+    };
+
+
+    // Separate-chaining table shared by HashSet and HashMap. ValueType is
+    // what each node stores, and KeyOfValue picks the part of it that is
+    // hashed and compared.
+    //
+    // Until it first holds more than KeyOfValue::INLINE_CAPACITY elements,
+    // the table keeps them in nodes inside the object and allocates nothing.
+    // Lookups then scan the inline hashes, and every inline node counts as a
+    // bucket of its own. Going over the limit moves the elements into a
+    // bucket array for good.
+    template <typename ValueType, typename KeyOfValue>
+    class HashTable
+    {
+    public:
+        static constexpr unsigned int DEFAULT_CAPACITY = 10;
+        static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.8;
+        static constexpr unsigned int SCAN_PREFETCH_DISTANCE = 8;
+        static constexpr unsigned int BUCKETS_PER_TASK = 4096;
+        static constexpr unsigned int BUILD_PARTITIONS = 64;
+        static constexpr unsigned int HASH_CHECK_MIN_SIZE = 1024;
+        static constexpr unsigned int INLINE_CAPACITY =
+            KeyOfValue::INLINE_CAPACITY;
+
+        using KeyType = typename KeyOfValue::KeyType;
+        using HashFunction = std::function<unsigned int(const KeyType&)>;
+
+        template <typename QualifiedValue>
+        class BasicIterator;
+
+        using Iterator = BasicIterator<ValueType>;
+        using ConstIterator = BasicIterator<const ValueType>;
+
+    public:
+        explicit HashTable(HashFunction hashFunction,
+            const HashSetMemoryOptions& memory = HashSetMemoryOptions{});
+        ~HashTable() noexcept;
+
+        HashTable(const HashTable& t);
+        HashTable(HashTable&& t) noexcept;
+
+        HashTable& operator=(const HashTable& t);
+        HashTable& operator=(HashTable&& t) noexcept;
+
+        unsigned int hash(const KeyType& key) const;
+        const HashFunction& hasher() const noexcept;
+        const HashSetMemoryOptions& memoryOptions() const noexcept;
+
+        template <typename... Args>
+        std::pair<Iterator, bool> emplace(unsigned int hash, const KeyType& key,
+            Args&&... args);
+        template <typename... Args>
+        std::pair<Iterator, bool> emplaceValue(unsigned int& hash,
+            Args&&... args);
+
+        Iterator find(const KeyType& key);
+        ConstIterator find(const KeyType& key) const;
+        Iterator findHashed(unsigned int hash, const KeyType& key);
+        bool contains(const KeyType& key) const;
+        bool containsHashed(unsigned int hash, const KeyType& key) const;
+
+        bool remove(const KeyType& key);
+        bool removeHashed(unsigned int hash, const KeyType& key);
+
+        template <typename Predicate>
+        unsigned int removeIf(Predicate predicate);
+
+        void prefetch(const KeyType* keys, unsigned int count,
+            unsigned int* hashes) const;
+
+        template <typename Visitor>
+        void forEachInBuckets(unsigned int first, unsigned int last,
+            Visitor& visitor) const;
+
+        template <typename OnMove>
+        unsigned int merge(HashTable& other, OnMove onMove);
+
+        template <typename Keep>
+        void buildParallel(const HashTable* const* sources,
+            unsigned int sourceCount, Keep keep, unsigned int expected,
+            unsigned int threadCount);
+
+        unsigned int size() const noexcept;
+        unsigned int elementsAtIndex(unsigned int index) const;
+        bool isKeyAtIndex(const KeyType& key, unsigned int index) const;
+
+        Iterator begin() noexcept;
+        Iterator end() noexcept;
+        ConstIterator begin() const noexcept;
+        ConstIterator end() const noexcept;
+
+        double loadFactor() const;
+        double maxLoadFactor() const noexcept;
+        void maxLoadFactor(double factor);
+        unsigned int bucketCount() const noexcept;
+
+        void reserve(unsigned int count);
+        void rehash(unsigned int buckets);
+        void shrinkToFit();
+
+        HashSetStatistics statistics() const;
+        HashSetHashQuality hashQuality() const;
+        void checkHashes(HashSetHashCheck check,
+            HashSetPoorHashHandler handler);
+
+    private:
+        struct Node {
+
+            template <typename... Args>
+            explicit Node(Node* next, Args&&... args);
+
+            ValueType value;
+            Node* next;
+        };
+
+        using NodePool = HashTable__NodePool<Node>;
+
+        HashFunction hashFunction;
+        Node** hashTable;
+        unsigned int sz, capacity;
+        double maxLoad;
+        HashSetMemoryOptions memory;
+        bool mixing;
+        HashSetHashCheck hashCheck;
+        HashSetPoorHashHandler onPoorHash;
+
+        // pool is created on first use. adopted keeps alive the pools of
+        // tables that merge() took nodes from.
+        std::shared_ptr<NodePool> pool;
+        std::vector<std::shared_ptr<NodePool>> adopted;
+
+        // In use while hashTable is null.
+        HashTable__inlineNodes<Node, INLINE_CAPACITY> inlineNodes;
+
+#ifdef HASH_SET_STATISTICS
+        struct Counters {
+
+            std::atomic<unsigned long long> hits{ 0 };
+            std::atomic<unsigned long long> misses{ 0 };
+            std::atomic<unsigned long long> hitProbes{ 0 };
+            std::atomic<unsigned long long> missProbes{ 0 };
+            std::atomic<unsigned int> resizeCount{ 0 };
+            std::atomic<unsigned long long> resizeNanoseconds{ 0 };
+        };
+
+        mutable Counters counters;
+#endif
+
+        Node* findNode(unsigned int index, const KeyType& key) const;
+        int findInline(unsigned int hash, const KeyType& key) const;
+        void recordLookup(bool found, unsigned int probes) const noexcept;
+        bool isInline() const noexcept;
+        unsigned int inlineSize() const noexcept;
+        void eraseInline(unsigned int index) noexcept;
+        void steal(HashTable& t) noexcept;
+        void promote(unsigned int newCapacity);
+        Node** allocateBuckets(unsigned int count) const;
+        void freeBuckets(Node** buckets, unsigned int count) const noexcept;
+        Node** copyBuckets(const HashTable& t, NodePool& into) const;
+        void destroyAll() noexcept;
+
+        NodePool& nodePool();
+
+        template <typename... Args>
+        static Node* createNode(NodePool& from, Args&&... args);
+        void destroyNode(Node* node) noexcept;
+        void rehashTo(unsigned int newCapacity);
+        unsigned int minimumBuckets(unsigned int count) const;
+        unsigned int bucketOf(unsigned int hash,
+            unsigned int buckets) const noexcept;
+        void checkHash();
+    };
+
+
+    template <typename ValueType, typename KeyOfValue>
+    template <typename QualifiedValue>
+    class HashTable<ValueType, KeyOfValue>::BasicIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = QualifiedValue*;
+        using reference = QualifiedValue&;
+
+    public:
+        BasicIterator() noexcept;
+
+        // Lets an Iterator convert to a ConstIterator.
+        template <typename OtherValue, typename = typename std::enable_if<
+            std::is_same<const OtherValue, QualifiedValue>::value>::type>
+        BasicIterator(const BasicIterator<OtherValue>& other) noexcept;
+
+        reference operator*() const noexcept;
+        pointer operator->() const noexcept;
+
+        BasicIterator& operator++() noexcept;
+        BasicIterator operator++(int) noexcept;
+
+        bool operator==(const BasicIterator& other) const noexcept;
+        bool operator!=(const BasicIterator& other) const noexcept;
+
+    private:
+        friend class HashTable;
+
+        template <typename OtherValue>
+        friend class BasicIterator;
+
+        BasicIterator(const HashTable* table, unsigned int index,
+            Node* node) noexcept;
+        void skipEmptyBuckets() noexcept;
+
+        const HashTable* table;
+        unsigned int index;
+        Node* node;
+    };
+}
+
+
+inline double HashSetStatistics::averageProbesPerHit() const noexcept
+{
+    return hits == 0 ? 0.0 : static_cast<double>(hitProbes) / hits;
+}
+
+
+inline double HashSetStatistics::averageProbesPerMiss() const noexcept
+{
+    return misses == 0 ? 0.0 : static_cast<double>(missProbes) / misses;
+}
+
+
+inline bool HashSetHashQuality::isPoor() const noexcept
+{
+    return deviation > POOR_DEVIATION;
+}
+
+
+inline bool HashSetMemoryOptions::isDefault() const noexcept
+{
+    return pages == Pages::DEFAULT && placement == Placement::DEFAULT;
+}
+
+
+template <typename NodeType>
+impl_::HashTable__NodePool<NodeType>::HashTable__NodePool(
+    const HashSetMemoryOptions& memory) noexcept
+    : memory{ memory }, freeList{ nullptr }, cursor{ nullptr }, remaining{ 0 },
+      slabNodes{ MIN_SLAB_NODES }, bytes{ 0 }
+{
+}
+
+
+template <typename NodeType>
+impl_::HashTable__NodePool<NodeType>::~HashTable__NodePool() noexcept
+{
+    for(const Slab& slab : slabs) {
+
+        HashTable__deallocate(slab.slots, slab.bytes, memory);
+    }
+}
+
+
+template <typename NodeType>
+void* impl_::HashTable__NodePool<NodeType>::allocate()
+{
+    if(freeList != nullptr) {
+
+        Slot* slot = freeList;
+        freeList = slot->next;
+
+        return slot->storage;
+    }
+
+    if(remaining == 0) {
+
+        std::size_t slabBytes = sizeof(Slot) * slabNodes;
+        std::size_t maxBytes = memory.isDefault() ? MAX_SLAB_BYTES :
+            HashSetMemoryOptions::HUGE_PAGE_BYTES;
+
+        if(HashTable__isMapped(slabBytes, memory)) {
+
+            slabBytes = HashTable__mappedLength(slabBytes) / sizeof(Slot) *
+                sizeof(Slot);
+        }
+
+        slabs.reserve(slabs.size() + 1);
+        cursor = static_cast<Slot*>(HashTable__allocate(slabBytes, memory));
+        slabs.push_back(Slab{ cursor, slabBytes });
+        remaining = slabBytes / sizeof(Slot);
+        bytes += slabBytes;
+
+        if(sizeof(Slot) * slabNodes * 2 <= maxBytes) {
+
+            slabNodes *= 2;
+        }
+    }
+
+    remaining--;
+
+    return (cursor++)->storage;
+}
+
+
+template <typename NodeType>
+void impl_::HashTable__NodePool<NodeType>::deallocate(void* node) noexcept
+{
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next = freeList;
+    freeList = slot;
+}
+
+
+// Takes over the slabs of other. Its free nodes, and the part of its last
+// slab it had not handed out yet, join this pool's free list.
+template <typename NodeType>
+void impl_::HashTable__NodePool<NodeType>::absorb(HashTable__NodePool& other)
+{
+    if(this == &other) {
+
+        return;
+    }
+
+    slabs.insert(slabs.end(), other.slabs.begin(), other.slabs.end());
+
+    for(; other.remaining > 0; other.remaining--) {
+
+        deallocate((other.cursor++)->storage);
+    }
+
+    while(other.freeList != nullptr) {
+
+        Slot* slot = other.freeList;
+        other.freeList = slot->next;
+        deallocate(slot->storage);
+    }
+
+    bytes += other.bytes;
+    other.slabs.clear();
+    other.cursor = nullptr;
+    other.bytes = 0;
+}
+
+
+template <typename NodeType>
+std::size_t impl_::HashTable__NodePool<NodeType>::bytesAllocated() const noexcept
+{
+    return bytes;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename... Args>
+impl_::HashTable<ValueType, KeyOfValue>::Node::Node(Node* next, Args&&... args)
+    : value(std::forward<Args>(args)...), next{ next }
+{
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+impl_::HashTable<ValueType, KeyOfValue>::HashTable(HashFunction hashFunction,
+    const HashSetMemoryOptions& memory)
+    : hashFunction{ hashFunction },
+      hashTable{ nullptr }, sz{ 0 }, capacity{ INLINE_CAPACITY },
+      maxLoad{ DEFAULT_MAX_LOAD_FACTOR }, memory{ memory }, mixing{ false },
+      hashCheck{ HashSetHashCheck::OFF }
+{
+    if(INLINE_CAPACITY == 0) {
+
+        hashTable = allocateBuckets(DEFAULT_CAPACITY);
+        capacity = DEFAULT_CAPACITY;
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+impl_::HashTable<ValueType, KeyOfValue>::~HashTable() noexcept
+{
+    destroyAll();
+    freeBuckets(hashTable, capacity);
+}
+
+
+// Builds a bucket-for-bucket copy of t's chains with nodes from into. The
+// elements already copied are destroyed again if copying one throws; their
+// nodes go away with the pool.
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Node**
+    impl_::HashTable<ValueType, KeyOfValue>::copyBuckets(
+    const HashTable& t, NodePool& into) const
+{
+    Node** newHashTable = allocateBuckets(t.capacity);
+
+    for(unsigned int i = 0; i < t.capacity; ++i) {
+
+        Node* originalHash = t.hashTable[i];
+
+        try {
+
+            while(originalHash != nullptr) {
+
+                newHashTable[i] = createNode(into, newHashTable[i],
+                    originalHash->value);
+                originalHash = originalHash->next;
+            }
+        }
+        catch(...) {
+
+            for(unsigned int j = 0; j <= i; ++j) {
+
+                while(newHashTable[j] != nullptr) {
+
+                    Node* next = newHashTable[j]->next;
+                    newHashTable[j]->~Node();
+                    newHashTable[j] = next;
+                }
+            }
+
+            freeBuckets(newHashTable, t.capacity);
+            throw;
+        }
+    }
+
+    return newHashTable;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+impl_::HashTable<ValueType, KeyOfValue>::HashTable(const HashTable& t)
+    : hashFunction{ t.hashFunction },
+      hashTable{ nullptr }, sz{ 0 }, capacity{ t.capacity },
+      maxLoad{ t.maxLoad }, memory{ t.memory }, mixing{ t.mixing },
+      hashCheck{ t.hashCheck }, onPoorHash{ t.onPoorHash }
+{
+    if(!t.isInline()) {
+
+        pool = std::make_shared<NodePool>(memory);
+        hashTable = copyBuckets(t, *pool);
+        sz = t.sz;
+
+        return;
+    }
+
+    try {
+
+        for(; sz < t.inlineSize(); ++sz) {
+
+            new(inlineNodes.node(sz)) Node{ nullptr,
+                t.inlineNodes.node(sz)->value };
+            inlineNodes.hashes[sz] = t.inlineNodes.hashes[sz];
+        }
+    }
+    catch(...) {
+
+        destroyAll();
+        throw;
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+impl_::HashTable<ValueType, KeyOfValue>::HashTable(HashTable&& t) noexcept
+    : hashFunction{ t.hashFunction },
+      hashTable{ nullptr }, sz{ 0 }, capacity{ INLINE_CAPACITY },
+      maxLoad{ t.maxLoad }, memory{ t.memory }, mixing{ false },
+      hashCheck{ t.hashCheck }, onPoorHash{ t.onPoorHash }
+{
+    steal(t);
+}
+
+
+// Takes over the elements of t, leaving it empty and inline. This table
+// must be empty and inline itself. Inline elements are moved one by one,
+// which cannot throw since INLINE_CAPACITY is 0 for types whose move might.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::steal(HashTable& t) noexcept
+{
+    std::swap(mixing, t.mixing);
+
+    if(!t.isInline()) {
+
+        std::swap(hashTable, t.hashTable);
+        std::swap(sz, t.sz);
+        std::swap(capacity, t.capacity);
+        std::swap(pool, t.pool);
+        std::swap(adopted, t.adopted);
+
+        return;
+    }
+
+    for(unsigned int i = 0; i < t.inlineSize(); ++i) {
+
+        Node* from = t.inlineNodes.node(i);
+
+        new(inlineNodes.node(i)) Node{ nullptr, std::move(from->value) };
+        inlineNodes.hashes[i] = t.inlineNodes.hashes[i];
+        from->~Node();
+    }
+
+    sz = t.sz;
+    t.sz = 0;
+}
+
+
+// Elements only need visiting when they have a destructor to run. The nodes
+// themselves are released a slab at a time when the last table referring to
+// the pool lets go of it.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::destroyAll() noexcept
+{
+    if(isInline()) {
+
+        for(unsigned int i = 0; i < inlineSize(); ++i) {
+
+            inlineNodes.node(i)->~Node();
+        }
+
+        sz = 0;
+
+        return;
+    }
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        if(!std::is_trivially_destructible<ValueType>::value) {
+
+            Node* current = hashTable[i];
+
+            while(current != nullptr) {
+
+                Node* next = current->next;
+                current->~Node();
+                current = next;
+            }
+        }
+
+        hashTable[i] = nullptr;
+    }
+
+    sz = 0;
+    pool.reset();
+    adopted.clear();
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::NodePool&
+    impl_::HashTable<ValueType, KeyOfValue>::nodePool()
+{
+    if(!pool) {
+
+        pool = std::make_shared<NodePool>(memory);
+    }
+
+    return *pool;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename... Args>
+typename impl_::HashTable<ValueType, KeyOfValue>::Node*
+    impl_::HashTable<ValueType, KeyOfValue>::createNode(NodePool& from,
+    Args&&... args)
+{
+    void* memory = from.allocate();
+
+    try {
+
+        return new(memory) Node{ std::forward<Args>(args)... };
+    }
+    catch(...) {
+
+        from.deallocate(memory);
+        throw;
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::destroyNode(Node* node) noexcept
+{
+    node->~Node();
+    pool->deallocate(node);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+impl_::HashTable<ValueType, KeyOfValue>&
+    impl_::HashTable<ValueType, KeyOfValue>::operator=(const HashTable& t)
+{
+    if(this != &t) {
+
+        HashTable copy{ t };
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+impl_::HashTable<ValueType, KeyOfValue>&
+    impl_::HashTable<ValueType, KeyOfValue>::operator=(HashTable&& t) noexcept
+{
+    if(this != &t) {
+
+        destroyAll();
+        freeBuckets(hashTable, capacity);
+
+        hashTable = nullptr;
+        capacity = INLINE_CAPACITY;
+
+        std::swap(hashFunction, t.hashFunction);
+        std::swap(onPoorHash, t.onPoorHash);
+        maxLoad = t.maxLoad;
+        memory = t.memory;
+        hashCheck = t.hashCheck;
+        steal(t);
+    }
+
+    return *this;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::hash(
+    const KeyType& key) const
+{
+    return hashFunction(key);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+const typename impl_::HashTable<ValueType, KeyOfValue>::HashFunction&
+    impl_::HashTable<ValueType, KeyOfValue>::hasher() const noexcept
+{
+    return hashFunction;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+const HashSetMemoryOptions&
+    impl_::HashTable<ValueType, KeyOfValue>::memoryOptions() const noexcept
+{
+    return memory;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+double impl_::HashTable<ValueType, KeyOfValue>::loadFactor() const
+{
+    return capacity == 0 ? 0.0 : static_cast<double>(sz) / capacity;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+double impl_::HashTable<ValueType, KeyOfValue>::maxLoadFactor() const noexcept
+{
+    return maxLoad;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::maxLoadFactor(double factor)
+{
+    if(!(factor > 0.0)) {
+
+        throw std::invalid_argument{ "Max load factor must be positive!" };
+    }
+
+    maxLoad = factor;
+
+    if(!isInline() && loadFactor() > maxLoad) {
+
+        rehash(minimumBuckets(sz));
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::bucketCount() const noexcept
+{
+    return capacity;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::minimumBuckets(
+    unsigned int count) const
+{
+    double buckets = std::ceil(static_cast<double>(count) / maxLoad);
+
+    return buckets < 1.0 ? 1 : static_cast<unsigned int>(buckets);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::reserve(unsigned int count)
+{
+    unsigned int buckets = minimumBuckets(count);
+
+    if(isInline()) {
+
+        if(count > INLINE_CAPACITY) {
+
+            promote(buckets);
+        }
+    }
+    else if(buckets > capacity) {
+
+        rehashTo(buckets);
+    }
+}
+
+
+// Never shrinks below what the current elements need at the max load factor.
+// An inline table only moves to a bucket array when asked for more buckets
+// than it has inline nodes.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::rehash(unsigned int buckets)
+{
+    if(isInline()) {
+
+        if(buckets > INLINE_CAPACITY) {
+
+            promote(std::max(buckets, minimumBuckets(sz)));
+        }
+
+        return;
+    }
+
+    unsigned int needed = minimumBuckets(sz);
+    unsigned int newCapacity = buckets > needed ? buckets : needed;
+
+    if(newCapacity != capacity) {
+
+        rehashTo(newCapacity);
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::shrinkToFit()
+{
+    rehash(0);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::rehashTo(unsigned int newCapacity)
+{
+#ifdef HASH_SET_STATISTICS
+    auto started = std::chrono::steady_clock::now();
+#endif
+
+    Node** newHashTable = allocateBuckets(newCapacity);
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        Node* head = hashTable[i];
+        while(head != nullptr) {
+
+            Node* current = head;
+            head = head->next;
+
+            unsigned int index = bucketOf(
+                hashFunction(KeyOfValue::key(current->value)), newCapacity);
+
+            Node*& newHash = newHashTable[index];
+
+            current->next = newHash;
+            newHash = current;
+        }
+    }
+
+    freeBuckets(hashTable, capacity);
+    capacity = newCapacity;
+    hashTable = newHashTable;
+
+#ifdef HASH_SET_STATISTICS
+    counters.resizeCount++;
+    counters.resizeNanoseconds += static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count());
+#endif
+}
+
+
+// Moves the inline elements into pool nodes of a new bucket array. Nodes
+// for all of them are allocated before any element moves, so running out
+// of memory leaves the table as it was.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::promote(unsigned int newCapacity)
+{
+    Node** newHashTable = allocateBuckets(newCapacity);
+    void* blocks[INLINE_CAPACITY + 1] = {};
+    unsigned int allocated = 0;
+
+    try {
+
+        NodePool& from = nodePool();
+
+        for(; allocated < inlineSize(); ++allocated) {
+
+            blocks[allocated] = from.allocate();
+        }
+    }
+    catch(...) {
+
+        while(allocated > 0) {
+
+            pool->deallocate(blocks[--allocated]);
+        }
+
+        freeBuckets(newHashTable, newCapacity);
+        throw;
+    }
+
+    for(unsigned int i = 0; i < inlineSize(); ++i) {
+
+        Node* inlineNode = inlineNodes.node(i);
+        Node*& head =
+            newHashTable[bucketOf(inlineNodes.hashes[i], newCapacity)];
+
+        head = new(blocks[i]) Node{ head, std::move(inlineNode->value) };
+        inlineNode->~Node();
+    }
+
+    hashTable = newHashTable;
+    capacity = newCapacity;
+}
+
+
+// Bucket arrays always start out empty. Mapped memory already is.
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Node**
+    impl_::HashTable<ValueType, KeyOfValue>::allocateBuckets(
+    unsigned int count) const
+{
+    std::size_t bytes = sizeof(Node*) * count;
+    Node** buckets = static_cast<Node**>(HashTable__allocate(bytes, memory));
+
+    if(!HashTable__isMapped(bytes, memory)) {
+
+        std::fill_n(buckets, count, nullptr);
+    }
+
+    return buckets;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::freeBuckets(Node** buckets,
+    unsigned int count) const noexcept
+{
+    HashTable__deallocate(buckets, sizeof(Node*) * count, memory);
+}
+
+
+// Walks the key's bucket exactly once. A node is only constructed from args
+// when no equal key was found along the way, so args may refer to key.
+template <typename ValueType, typename KeyOfValue>
+template <typename... Args>
+std::pair<typename impl_::HashTable<ValueType, KeyOfValue>::Iterator, bool>
+    impl_::HashTable<ValueType, KeyOfValue>::emplace(unsigned int hash,
+    const KeyType& key, Args&&... args)
+{
+    if(isInline()) {
+
+        int found = findInline(hash, key);
+
+        if(found >= 0) {
+
+            return { Iterator{ this, static_cast<unsigned int>(found),
+                inlineNodes.node(found) }, false };
+        }
+
+        if(sz < INLINE_CAPACITY) {
+
+            Node* current = new(inlineNodes.node(sz)) Node{ nullptr,
+                std::forward<Args>(args)... };
+            inlineNodes.hashes[sz] = hash;
+
+            return { Iterator{ this, sz++, current }, true };
+        }
+
+        promote(minimumBuckets(2 * sz + 1));
+    }
+    else {
+
+        unsigned int index = bucketOf(hash, capacity);
+        Node* found = findNode(index, key);
+
+        if(found != nullptr) {
+
+            return { Iterator{ this, index, found }, false };
+        }
+
+        if(loadFactor() > maxLoad) {
+
+            rehashTo(capacity * 2 + 1);
+        }
+    }
+
+    unsigned int index = bucketOf(hash, capacity);
+
+    Node* current = createNode(nodePool(), hashTable[index],
+        std::forward<Args>(args)...);
+    hashTable[index] = current;
+    sz++;
+
+    if(hashCheck != HashSetHashCheck::OFF && sz >= HASH_CHECK_MIN_SIZE &&
+        (sz & (sz - 1)) == 0) {
+
+        checkHash();
+        index = bucketOf(hash, capacity);
+    }
+
+    return { Iterator{ this, index, current }, true };
+}
+
+
+// For values whose key is only known once they exist. The value is built
+// from args in its final node, or inline slot, before its key is hashed;
+// on a hit it is destroyed again and the node returned to the pool. The
+// key's hash is left in hash. A full inline table is promoted before the
+// lookup, since the new value needs a node either way.
+template <typename ValueType, typename KeyOfValue>
+template <typename... Args>
+std::pair<typename impl_::HashTable<ValueType, KeyOfValue>::Iterator, bool>
+    impl_::HashTable<ValueType, KeyOfValue>::emplaceValue(unsigned int& hash,
+    Args&&... args)
+{
+    if(isInline() && sz == INLINE_CAPACITY) {
+
+        promote(minimumBuckets(2 * sz + 1));
+    }
+
+    if(isInline()) {
+
+        Node* current = new(inlineNodes.node(sz)) Node{ nullptr,
+            std::forward<Args>(args)... };
+        int found = -1;
+
+        try {
+
+            hash = this->hash(KeyOfValue::key(current->value));
+            found = findInline(hash, KeyOfValue::key(current->value));
+        }
+        catch(...) {
+
+            current->~Node();
+            throw;
+        }
+
+        if(found >= 0) {
+
+            current->~Node();
+
+            return { Iterator{ this, static_cast<unsigned int>(found),
+                inlineNodes.node(found) }, false };
+        }
+
+        inlineNodes.hashes[sz] = hash;
+
+        return { Iterator{ this, sz++, current }, true };
+    }
+
+    Node* current = createNode(nodePool(), nullptr, std::forward<Args>(args)...);
+    unsigned int index = 0;
+
+    try {
+
+        hash = this->hash(KeyOfValue::key(current->value));
+        index = bucketOf(hash, capacity);
+        Node* found = findNode(index, KeyOfValue::key(current->value));
+
+        if(found != nullptr) {
+
+            destroyNode(current);
+
+            return { Iterator{ this, index, found }, false };
+        }
+
+        if(loadFactor() > maxLoad) {
+
+            rehashTo(capacity * 2 + 1);
+            index = bucketOf(hash, capacity);
+        }
+    }
+    catch(...) {
+
+        destroyNode(current);
+        throw;
+    }
+
+    current->next = hashTable[index];
+    hashTable[index] = current;
+    sz++;
+
+    if(hashCheck != HashSetHashCheck::OFF && sz >= HASH_CHECK_MIN_SIZE &&
+        (sz & (sz - 1)) == 0) {
+
+        checkHash();
+        index = bucketOf(hash, capacity);
+    }
+
+    return { Iterator{ this, index, current }, true };
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Node*
+    impl_::HashTable<ValueType, KeyOfValue>::findNode(unsigned int index,
+    const KeyType& key) const
+{
+    unsigned int probes = 0;
+    Node* find = hashTable[index];
+
+    while(find != nullptr) {
+
+        probes++;
+
+        if(KeyOfValue::key(find->value) == key) {
+
+            break;
+        }
+
+        find = find->next;
+    }
+
+    recordLookup(find != nullptr, probes);
+
+    return find;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+int impl_::HashTable<ValueType, KeyOfValue>::findInline(unsigned int hash,
+    const KeyType& key) const
+{
+    unsigned int probes = 0;
+    int found = -1;
+
+    for(unsigned int i = 0; i < inlineSize(); ++i) {
+
+        if(inlineNodes.hashes[i] == hash) {
+
+            probes++;
+
+            if(KeyOfValue::key(inlineNodes.node(i)->value) == key) {
+
+                found = static_cast<int>(i);
+                break;
+            }
+        }
+    }
+
+    recordLookup(found >= 0, probes);
+
+    return found;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::recordLookup(bool found,
+    unsigned int probes) const noexcept
+{
+#ifdef HASH_SET_STATISTICS
+    if(found) {
+
+        counters.hits.fetch_add(1, std::memory_order_relaxed);
+        counters.hitProbes.fetch_add(probes, std::memory_order_relaxed);
+    }
+    else {
+
+        counters.misses.fetch_add(1, std::memory_order_relaxed);
+        counters.missProbes.fetch_add(probes, std::memory_order_relaxed);
+    }
+#else
+    static_cast<void>(found);
+    static_cast<void>(probes);
+#endif
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::isInline() const noexcept
+{
+    return hashTable == nullptr;
+}
+
+
+// The number of inline elements, spelled so that loops over them vanish
+// when INLINE_CAPACITY is 0.
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::inlineSize()
+    const noexcept
+{
+    return INLINE_CAPACITY == 0 ? 0 : sz;
+}
+
+
+// Destroys the element at index and moves the last inline element into its
+// place.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::eraseInline(
+    unsigned int index) noexcept
+{
+    if(index >= inlineSize()) {
+
+        return;
+    }
+
+    Node* hole = inlineNodes.node(index);
+    hole->~Node();
+    sz--;
+
+    if(index != sz) {
+
+        Node* last = inlineNodes.node(sz);
+
+        new(hole) Node{ nullptr, std::move(last->value) };
+        inlineNodes.hashes[index] = inlineNodes.hashes[sz];
+        last->~Node();
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Iterator
+    impl_::HashTable<ValueType, KeyOfValue>::find(const KeyType& key)
+{
+    return findHashed(hashFunction(key), key);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::ConstIterator
+    impl_::HashTable<ValueType, KeyOfValue>::find(const KeyType& key) const
+{
+    if(isInline()) {
+
+        int found = findInline(hashFunction(key), key);
+
+        return found >= 0 ? ConstIterator{ this,
+            static_cast<unsigned int>(found), inlineNodes.node(found) } : end();
+    }
+
+    unsigned int index = bucketOf(hashFunction(key), capacity);
+    Node* found = findNode(index, key);
+
+    return found != nullptr ? ConstIterator{ this, index, found } : end();
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Iterator
+    impl_::HashTable<ValueType, KeyOfValue>::findHashed(unsigned int hash,
+    const KeyType& key)
+{
+    if(isInline()) {
+
+        int found = findInline(hash, key);
+
+        return found >= 0 ? Iterator{ this, static_cast<unsigned int>(found),
+            inlineNodes.node(found) } : end();
+    }
+
+    unsigned int index = bucketOf(hash, capacity);
+    Node* found = findNode(index, key);
+
+    return found != nullptr ? Iterator{ this, index, found } : end();
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::contains(const KeyType& key) const
+{
+    return containsHashed(hashFunction(key), key);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::containsHashed(unsigned int hash,
+    const KeyType& key) const
+{
+    if(isInline()) {
+
+        return findInline(hash, key) >= 0;
+    }
+
+    return findNode(bucketOf(hash, capacity), key) != nullptr;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::remove(const KeyType& key)
+{
+    return removeHashed(hashFunction(key), key);
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::removeHashed(unsigned int hash,
+    const KeyType& key)
+{
+    if(isInline()) {
+
+        int found = findInline(hash, key);
+
+        if(found < 0) {
+
+            return false;
+        }
+
+        eraseInline(static_cast<unsigned int>(found));
+
+        return true;
+    }
+
+    unsigned int index = bucketOf(hash, capacity);
+
+    for(Node** link = &hashTable[index]; *link != nullptr;
+        link = &(*link)->next) {
+
+        if(KeyOfValue::key((*link)->value) == key) {
+
+            Node* found = *link;
+            *link = found->next;
+
+            destroyNode(found);
+            sz--;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename Predicate>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::removeIf(
+    Predicate predicate)
+{
+    unsigned int removed = 0;
+
+    if(isInline()) {
+
+        for(unsigned int i = 0; i < inlineSize();) {
+
+            if(predicate(static_cast<const ValueType&>(
+                inlineNodes.node(i)->value))) {
+
+                eraseInline(i);
+                removed++;
+            }
+            else {
+
+                ++i;
+            }
+        }
+
+        return removed;
+    }
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        Node** link = &hashTable[i];
+
+        while(*link != nullptr) {
+
+            Node* current = *link;
+
+            if(predicate(static_cast<const ValueType&>(current->value))) {
+
+                *link = current->next;
+                destroyNode(current);
+                removed++;
+            }
+            else {
+
+                link = &current->next;
+            }
+        }
+    }
+
+    sz -= removed;
+
+    return removed;
+}
+
+
+// Hashes a group of keys and prefetches their bucket slots, then prefetches
+// the head node of each bucket, so that the cache misses of the whole group
+// overlap instead of being paid one lookup at a time.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::prefetch(const KeyType* keys,
+    unsigned int count, unsigned int* hashes) const
+{
+    if(isInline()) {
+
+        for(unsigned int i = 0; i < count; ++i) {
+
+            hashes[i] = hashFunction(keys[i]);
+        }
+
+        return;
+    }
+
+    for(unsigned int i = 0; i < count; ++i) {
+
+        hashes[i] = hashFunction(keys[i]);
+        HashSet__prefetch(&hashTable[bucketOf(hashes[i], capacity)]);
+    }
+
+    for(unsigned int i = 0; i < count; ++i) {
+
+        Node* head = hashTable[bucketOf(hashes[i], capacity)];
+
+        if(head != nullptr) {
+
+            HashSet__prefetch(head);
+        }
+    }
+}
+
+
+// Walks the bucket array front to back and prefetches the head node of the
+// bucket SCAN_PREFETCH_DISTANCE ahead, so chain nodes are already on their
+// way by the time they are visited.
+template <typename ValueType, typename KeyOfValue>
+template <typename Visitor>
+void impl_::HashTable<ValueType, KeyOfValue>::forEachInBuckets(
+    unsigned int first, unsigned int last, Visitor& visitor) const
+{
+    if(isInline()) {
+
+        for(unsigned int i = first; i < std::min(last, inlineSize()); ++i) {
+
+            visitor(static_cast<const ValueType&>(inlineNodes.node(i)->value));
+        }
+
+        return;
+    }
+
+    last = std::min(last, capacity);
+
+    for(unsigned int i = first; i < last; ++i) {
+
+        if(i + SCAN_PREFETCH_DISTANCE < last &&
+            hashTable[i + SCAN_PREFETCH_DISTANCE] != nullptr) {
+
+            HashSet__prefetch(hashTable[i + SCAN_PREFETCH_DISTANCE]);
+        }
+
+        for(const Node* current = hashTable[i]; current != nullptr;
+            current = current->next) {
+
+            visitor(static_cast<const ValueType&>(current->value));
+        }
+    }
+}
+
+
+// Relinks every node of other whose key is missing here, so no element is
+// copied or reallocated; nodes with keys already present stay in other.
+// The table is grown for both sizes up front, and other's node pool is kept
+// alive for as long as this table is. Inline elements of other are moved
+// rather than relinked. onMove receives the hash of each moved element.
+template <typename ValueType, typename KeyOfValue>
+template <typename OnMove>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::merge(HashTable& other,
+    OnMove onMove)
+{
+    if(this == &other) {
+
+        return 0;
+    }
+
+    unsigned int moved = 0;
+
+    if(other.isInline()) {
+
+        for(unsigned int i = 0; i < other.inlineSize();) {
+
+            ValueType& value = other.inlineNodes.node(i)->value;
+            const KeyType& key = KeyOfValue::key(value);
+            unsigned int hash = hashFunction(key);
+
+            if(emplace(hash, key, std::move(value)).second) {
+
+                other.eraseInline(i);
+                moved++;
+
+                onMove(hash);
+            }
+            else {
+
+                ++i;
+            }
+        }
+
+        return moved;
+    }
+
+    if(isInline()) {
+
+        promote(minimumBuckets(sz + other.sz));
+    }
+
+    reserve(sz + other.sz);
+    nodePool();
+
+    if(other.pool && std::find(adopted.begin(), adopted.end(), other.pool) ==
+        adopted.end()) {
+
+        adopted.push_back(other.pool);
+    }
+
+    for(unsigned int i = 0; i < other.capacity; ++i) {
+
+        Node** link = &other.hashTable[i];
+
+        while(*link != nullptr) {
+
+            Node* current = *link;
+            const KeyType& key = KeyOfValue::key(current->value);
+            unsigned int hash = hashFunction(key);
+            unsigned int index = bucketOf(hash, capacity);
+            Node* find = hashTable[index];
+
+            while(find != nullptr && !(KeyOfValue::key(find->value) == key)) {
+
+                find = find->next;
+            }
+
+            if(find != nullptr) {
+
+                link = &current->next;
+                continue;
+            }
+
+            *link = current->next;
+            current->next = hashTable[index];
+            hashTable[index] = current;
+            sz++;
+            other.sz--;
+            moved++;
+
+            onMove(hash);
+        }
+    }
+
+    checkHash();
+
+    return moved;
+}
+
+
+// Fills this empty table with the values of sources that pass keep, without
+// any resize. The bucket array is sized for expected elements and split into
+// BUILD_PARTITIONS ranges. Threads first scan runs of source buckets and
+// sort the kept values by the range their bucket falls in; then each range
+// is linked by a single thread, so no two threads touch the same bucket.
+// Each range takes its nodes from a pool of its own, and those pools are
+// folded into the table's once every range is done. A result that fits
+// inline is filled on the calling thread instead.
+template <typename ValueType, typename KeyOfValue>
+template <typename Keep>
+void impl_::HashTable<ValueType, KeyOfValue>::buildParallel(
+    const HashTable* const* sources, unsigned int sourceCount, Keep keep,
+    unsigned int expected, unsigned int threadCount)
+{
+    struct Staged {
+
+        const ValueType* value;
+        unsigned int index;
+    };
+
+    struct Task {
+
+        const HashTable* source;
+        unsigned int first;
+    };
+
+    if(isInline() && expected <= INLINE_CAPACITY) {
+
+        auto add = [&](const ValueType& value) {
+
+            if(keep(value)) {
+
+                const KeyType& key = KeyOfValue::key(value);
+                emplace(hashFunction(key), key, value);
+            }
+        };
+
+        try {
+
+            for(unsigned int s = 0; s < sourceCount; ++s) {
+
+                sources[s]->forEachInBuckets(0, sources[s]->capacity, add);
+            }
+        }
+        catch(...) {
+
+            destroyAll();
+            throw;
+        }
+
+        return;
+    }
+
+    if(isInline()) {
+
+        promote(minimumBuckets(expected));
+    }
+    else {
+
+        rehashTo(std::max(capacity, minimumBuckets(expected)));
+    }
+
+    std::vector<Task> tasks;
+    for(unsigned int s = 0; s < sourceCount; ++s) {
+
+        for(unsigned int first = 0; first < sources[s]->capacity;
+            first += BUCKETS_PER_TASK) {
+
+            tasks.push_back(Task{ sources[s], first });
+        }
+    }
+
+    std::vector<std::vector<Staged>> staged(tasks.size() * BUILD_PARTITIONS);
+    unsigned int buckets = capacity;
+
+    HashTable__runParallel(static_cast<unsigned int>(tasks.size()), threadCount,
+        [&](unsigned int t) {
+
+        std::vector<Staged>* partitions = &staged[t * BUILD_PARTITIONS];
+        auto stage = [&](const ValueType& value) {
+
+            if(keep(value)) {
+
+                unsigned int index =
+                    bucketOf(hashFunction(KeyOfValue::key(value)), buckets);
+                unsigned long long partition =
+                    static_cast<unsigned long long>(index) * BUILD_PARTITIONS /
+                    buckets;
+
+                partitions[partition].push_back(Staged{ &value, index });
+            }
+        };
+
+        tasks[t].source->forEachInBuckets(tasks[t].first,
+            tasks[t].first + BUCKETS_PER_TASK, stage);
+    });
+
+    std::vector<unsigned int> added(BUILD_PARTITIONS, 0);
+    std::vector<std::unique_ptr<NodePool>> partitionPools;
+    for(unsigned int p = 0; p < BUILD_PARTITIONS; ++p) {
+
+        partitionPools.emplace_back(new NodePool{ memory });
+    }
+
+    try {
+
+        HashTable__runParallel(BUILD_PARTITIONS, threadCount,
+            [&](unsigned int p) {
+
+            for(std::size_t t = 0; t < tasks.size(); ++t) {
+
+                for(const Staged& item : staged[t * BUILD_PARTITIONS + p]) {
+
+                    const KeyType& key = KeyOfValue::key(*item.value);
+                    Node* find = hashTable[item.index];
+
+                    while(find != nullptr &&
+                        !(KeyOfValue::key(find->value) == key)) {
+
+                        find = find->next;
+                    }
+
+                    if(find == nullptr) {
+
+                        hashTable[item.index] = createNode(*partitionPools[p],
+                            hashTable[item.index], *item.value);
+                        added[p]++;
+                    }
+                }
+            }
+        });
+
+        for(std::unique_ptr<NodePool>& partitionPool : partitionPools) {
+
+            nodePool().absorb(*partitionPool);
+        }
+    }
+    catch(...) {
+
+        destroyAll();
+        throw;
+    }
+
+    for(unsigned int count : added) {
+
+        sz += count;
+    }
+
+    checkHash();
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::size() const noexcept
+{
+    return sz;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::elementsAtIndex(
+    unsigned int index) const
+{
+    unsigned int temp = 0;
+
+    if(isInline()) {
+
+        return index < sz ? 1 : 0;
+    }
+
+    if(index < capacity) {
+
+        for(Node* current = hashTable[index]; current != nullptr;
+            current = current->next) {
+
+            temp++;
+        }
+    }
+
+    return temp;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::isKeyAtIndex(const KeyType& key,
+    unsigned int index) const
+{
+    if(isInline()) {
+
+        return index < inlineSize() &&
+            KeyOfValue::key(inlineNodes.node(index)->value) == key;
+    }
+
+    if(index < capacity) {
+
+        for(Node* current = hashTable[index]; current != nullptr;
+            current = current->next) {
+
+            if(KeyOfValue::key(current->value) == key) {
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+HashSetStatistics impl_::HashTable<ValueType, KeyOfValue>::statistics() const
+{
+    HashSetStatistics stats{};
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        unsigned int length = elementsAtIndex(i);
+
+        if(length >= stats.chainLengthHistogram.size()) {
+
+            stats.chainLengthHistogram.resize(length + 1);
+        }
+
+        stats.chainLengthHistogram[length]++;
+    }
+
+    stats.bytesAllocated = isInline() ? 0 : sizeof(Node*) * capacity;
+
+    if(pool) {
+
+        stats.bytesAllocated += pool->bytesAllocated();
+    }
+
+#ifdef HASH_SET_STATISTICS
+    stats.hits = counters.hits.load();
+    stats.misses = counters.misses.load();
+    stats.hitProbes = counters.hitProbes.load();
+    stats.missProbes = counters.missProbes.load();
+    stats.resizeCount = counters.resizeCount.load();
+    stats.resizeSeconds = counters.resizeNanoseconds.load() / 1e9;
+#endif
+
+    return stats;
+}
+
+
+// For a uniform hash, chain lengths are Poisson with mean sz / capacity.
+// Each sampled bucket adds (length - mean)^2 / mean to the statistic, whose
+// expectation is 1 and variance 2 + 1 / mean. Buckets are sampled by a
+// multiplicative sequence rather than a stride, which a clustering hash
+// could line up with.
+template <typename ValueType, typename KeyOfValue>
+HashSetHashQuality impl_::HashTable<ValueType, KeyOfValue>::hashQuality() const
+{
+    HashSetHashQuality quality{};
+    quality.mixing = mixing;
+
+    if(isInline() || sz == 0) {
+
+        return quality;
+    }
+
+    unsigned int samples =
+        std::min(capacity, HashSetHashQuality::SAMPLE_BUCKETS);
+    double mean = static_cast<double>(sz) / capacity;
+
+    for(unsigned int i = 0; i < samples; ++i) {
+
+        unsigned int index = samples == capacity ? i :
+            static_cast<unsigned int>(
+            static_cast<unsigned long long>(i) * 2654435761u % capacity);
+        unsigned int length = elementsAtIndex(index);
+
+        quality.longestChain = std::max(quality.longestChain, length);
+        quality.chiSquare += (length - mean) * (length - mean) / mean;
+    }
+
+    quality.sampledBuckets = samples;
+    quality.deviation = (quality.chiSquare - samples) /
+        std::sqrt(samples * (2.0 + 1.0 / mean));
+
+    return quality;
+}
+
+
+// Checks right away, then each time an insert brings the size to a power of
+// two, which costs O(log n) checks in all, and after every merge and
+// parallel build.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::checkHashes(
+    HashSetHashCheck check, HashSetPoorHashHandler handler)
+{
+    hashCheck = check;
+    onPoorHash = std::move(handler);
+
+    checkHash();
+}
+
+
+// Does nothing unless checking is on and the table holds at least
+// HASH_CHECK_MIN_SIZE elements. Switching to mixing relinks every node in
+// place. If keys still cluster after that, the handler hears about it.
+template <typename ValueType, typename KeyOfValue>
+void impl_::HashTable<ValueType, KeyOfValue>::checkHash()
+{
+    if(hashCheck == HashSetHashCheck::OFF || sz < HASH_CHECK_MIN_SIZE ||
+        isInline()) {
+
+        return;
+    }
+
+    HashSetHashQuality quality = hashQuality();
+
+    if(quality.isPoor() && hashCheck == HashSetHashCheck::MIX && !mixing) {
+
+        mixing = true;
+        rehashTo(capacity);
+        quality = hashQuality();
+    }
+
+    if(quality.isPoor() && onPoorHash) {
+
+        onPoorHash(quality);
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+unsigned int impl_::HashTable<ValueType, KeyOfValue>::bucketOf(
+    unsigned int hash, unsigned int buckets) const noexcept
+{
+    return (mixing ? HashTable__mix(hash) : hash) % buckets;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Iterator
+    impl_::HashTable<ValueType, KeyOfValue>::begin() noexcept
+{
+    Iterator first{ this, 0, nullptr };
+    first.skipEmptyBuckets();
+
+    return first;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::Iterator
+    impl_::HashTable<ValueType, KeyOfValue>::end() noexcept
+{
+    return Iterator{ this, capacity, nullptr };
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::ConstIterator
+    impl_::HashTable<ValueType, KeyOfValue>::begin() const noexcept
+{
+    ConstIterator first{ this, 0, nullptr };
+    first.skipEmptyBuckets();
+
+    return first;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::ConstIterator
+    impl_::HashTable<ValueType, KeyOfValue>::end() const noexcept
+{
+    return ConstIterator{ this, capacity, nullptr };
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    BasicIterator() noexcept
+    : table{ nullptr }, index{ 0 }, node{ nullptr }
+{
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+template <typename OtherValue, typename>
+impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    BasicIterator(const BasicIterator<OtherValue>& other) noexcept
+    : table{ other.table }, index{ other.index }, node{ other.node }
+{
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    BasicIterator(const HashTable* table, unsigned int index,
+    Node* node) noexcept
+    : table{ table }, index{ index }, node{ node }
+{
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+void impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    skipEmptyBuckets() noexcept
+{
+    if(table->isInline()) {
+
+        node = index < table->inlineSize() ?
+            table->inlineNodes.node(index) : nullptr;
+        index = node != nullptr ? index : table->capacity;
+
+        return;
+    }
+
+    while(node == nullptr && index < table->capacity) {
+
+        node = table->hashTable[index];
+
+        if(node == nullptr) {
+
+            index++;
+        }
+    }
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+QualifiedValue& impl_::HashTable<ValueType, KeyOfValue>::
+    BasicIterator<QualifiedValue>::operator*() const noexcept
+{
+    return node->value;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+QualifiedValue* impl_::HashTable<ValueType, KeyOfValue>::
+    BasicIterator<QualifiedValue>::operator->() const noexcept
+{
+    return &node->value;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::template
+    BasicIterator<QualifiedValue>&
+    impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    operator++() noexcept
+{
+    node = node->next;
+
+    if(node == nullptr) {
+
+        index++;
+        skipEmptyBuckets();
+    }
+
+    return *this;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+typename impl_::HashTable<ValueType, KeyOfValue>::template
+    BasicIterator<QualifiedValue>
+    impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    operator++(int) noexcept
+{
+    BasicIterator previous = *this;
+    ++(*this);
+
+    return previous;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    operator==(const BasicIterator& other) const noexcept
+{
+    return node == other.node;
+}
+
+
+template <typename ValueType, typename KeyOfValue>
+template <typename QualifiedValue>
+bool impl_::HashTable<ValueType, KeyOfValue>::BasicIterator<QualifiedValue>::
+    operator!=(const BasicIterator& other) const noexcept
+{
+    return node != other.node;
+}
+
+#endif // HASH_TABLE_HPP
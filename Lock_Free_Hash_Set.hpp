@@ -0,0 +1,449 @@
+// Lock_Free_Hash_Set.hpp
+#ifndef LOCK_FREE_HASH_SET_HPP
+#define LOCK_FREE_HASH_SET_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "Epoch_Reclamation.hpp"
+#include "Hash_Map.hpp"
+
+// Split-ordered list hash set (Shalev and Shavit). All elements live in one
+// lock-free linked list sorted by bit-reversed hash, and the bucket array
+// only holds shortcuts into it, so doubling the bucket count never moves an
+// element. Buckets are initialized lazily the first time they are used.
+template <typename ElementType>
+class LockFreeHashSet : public Set<ElementType>
+{
+public:
+    static constexpr unsigned int DEFAULT_MAX_LOAD = 2;
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    explicit LockFreeHashSet(HashFunction hashFunction);
+    ~LockFreeHashSet() noexcept override;
+
+    LockFreeHashSet(const LockFreeHashSet& s) = delete;
+    LockFreeHashSet& operator=(const LockFreeHashSet& s) = delete;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+    bool insert(const ElementType& element);
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+    unsigned int bucketCount() const noexcept;
+
+private:
+    static constexpr unsigned int SEGMENT_COUNT = 32;
+
+    // Dummy nodes mark the start of a bucket and have even keys; element
+    // nodes have odd keys. The low bit of next flags a logically removed node.
+    struct Node {
+
+        std::atomic<Node*> next;
+        unsigned int key;
+    };
+
+    struct ElementNode : Node {
+
+        ElementType value;
+    };
+
+    HashFunction hashFunction;
+    mutable std::atomic<std::atomic<Node*>*> segments[SEGMENT_COUNT];
+    std::atomic<unsigned int> sz, capacity;
+    mutable EpochReclaimer reclaimer;
+
+    static unsigned int reverseBits(unsigned int bits) noexcept;
+    static bool isMarked(Node* node) noexcept;
+    static Node* marked(Node* node) noexcept;
+    static Node* unmarked(Node* node) noexcept;
+    static void destroyNode(Node* node) noexcept;
+
+    std::atomic<Node*>& bucket(unsigned int index) const;
+    Node* bucketHead(unsigned int index) const;
+    Node* initializeBucket(unsigned int index) const;
+
+    bool find(Node* start, unsigned int key, const ElementType* element,
+        std::atomic<Node*>*& previous, Node*& current) const;
+};
+
+
+template <typename ElementType>
+LockFreeHashSet<ElementType>::LockFreeHashSet(HashFunction hashFunction)
+    : hashFunction{ hashFunction }, sz{ 0 }, capacity{ 2 }
+{
+    for(unsigned int i = 0; i < SEGMENT_COUNT; ++i) {
+
+        segments[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    Node* head = new Node;
+    head->next.store(nullptr, std::memory_order_relaxed);
+    head->key = 0;
+
+    bucket(0).store(head);
+}
+
+
+template <typename ElementType>
+LockFreeHashSet<ElementType>::~LockFreeHashSet() noexcept
+{
+    Node* current = bucket(0).load();
+
+    while(current != nullptr) {
+
+        Node* next = unmarked(current->next.load());
+        destroyNode(current);
+        current = next;
+    }
+
+    for(unsigned int i = 0; i < SEGMENT_COUNT; ++i) {
+
+        delete[] segments[i].load();
+    }
+}
+
+
+template <typename ElementType>
+unsigned int LockFreeHashSet<ElementType>::reverseBits(unsigned int bits) noexcept
+{
+    bits = ((bits >> 1) & 0x55555555u) | ((bits & 0x55555555u) << 1);
+    bits = ((bits >> 2) & 0x33333333u) | ((bits & 0x33333333u) << 2);
+    bits = ((bits >> 4) & 0x0f0f0f0fu) | ((bits & 0x0f0f0f0fu) << 4);
+    bits = ((bits >> 8) & 0x00ff00ffu) | ((bits & 0x00ff00ffu) << 8);
+
+    return (bits >> 16) | (bits << 16);
+}
+
+
+template <typename ElementType>
+bool LockFreeHashSet<ElementType>::isMarked(Node* node) noexcept
+{
+    return (reinterpret_cast<std::uintptr_t>(node) & 1) != 0;
+}
+
+
+template <typename ElementType>
+typename LockFreeHashSet<ElementType>::Node*
+    LockFreeHashSet<ElementType>::marked(Node* node) noexcept
+{
+    return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(node) | 1);
+}
+
+
+template <typename ElementType>
+typename LockFreeHashSet<ElementType>::Node*
+    LockFreeHashSet<ElementType>::unmarked(Node* node) noexcept
+{
+    return reinterpret_cast<Node*>(
+        reinterpret_cast<std::uintptr_t>(node) & ~std::uintptr_t{ 1 });
+}
+
+
+template <typename ElementType>
+void LockFreeHashSet<ElementType>::destroyNode(Node* node) noexcept
+{
+    if((node->key & 1) != 0) {
+
+        delete static_cast<ElementNode*>(node);
+    }
+    else {
+
+        delete node;
+    }
+}
+
+
+// Segment 0 holds buckets 0 and 1, and segment s > 0 holds buckets
+// [2^s, 2^(s+1)). Segments are allocated on first use and never move.
+template <typename ElementType>
+std::atomic<typename LockFreeHashSet<ElementType>::Node*>&
+    LockFreeHashSet<ElementType>::bucket(unsigned int index) const
+{
+    unsigned int segment = 0;
+    unsigned int first = 0;
+
+    if(index >= 2) {
+
+        while((index >> (segment + 1)) != 0) {
+
+            segment++;
+        }
+
+        first = 1u << segment;
+    }
+
+    unsigned int length = segment == 0 ? 2 : first;
+    std::atomic<Node*>* buckets = segments[segment].load();
+
+    if(buckets == nullptr) {
+
+        std::atomic<Node*>* fresh = new std::atomic<Node*>[length];
+
+        for(unsigned int i = 0; i < length; ++i) {
+
+            fresh[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        if(segments[segment].compare_exchange_strong(buckets, fresh)) {
+
+            buckets = fresh;
+        }
+        else {
+
+            delete[] fresh;
+        }
+    }
+
+    return buckets[index - first];
+}
+
+
+template <typename ElementType>
+typename LockFreeHashSet<ElementType>::Node*
+    LockFreeHashSet<ElementType>::bucketHead(unsigned int index) const
+{
+    Node* head = bucket(index).load();
+
+    return head != nullptr ? head : initializeBucket(index);
+}
+
+
+// A bucket's dummy is spliced in after its parent bucket's dummy, the parent
+// being the same index with its highest set bit cleared.
+template <typename ElementType>
+typename LockFreeHashSet<ElementType>::Node*
+    LockFreeHashSet<ElementType>::initializeBucket(unsigned int index) const
+{
+    unsigned int parent = index;
+    unsigned int bit = 1u << 31;
+
+    while((parent & bit) == 0) {
+
+        bit >>= 1;
+    }
+
+    parent &= ~bit;
+
+    Node* dummy = new Node;
+    dummy->key = reverseBits(index);
+
+    Node* start = bucketHead(parent);
+    std::atomic<Node*>* previous = nullptr;
+    Node* current = nullptr;
+
+    while(true) {
+
+        if(find(start, dummy->key, nullptr, previous, current)) {
+
+            delete dummy;
+            dummy = current;
+            break;
+        }
+
+        dummy->next.store(current, std::memory_order_relaxed);
+
+        if(previous->compare_exchange_strong(current, dummy)) {
+
+            break;
+        }
+    }
+
+    bucket(index).store(dummy);
+
+    return dummy;
+}
+
+
+// Harris-Michael search from start. Leaves previous pointing at the link
+// that holds current, where current is the first node not ordered before
+// (key, element). Marked nodes met on the way are unlinked and retired.
+template <typename ElementType>
+bool LockFreeHashSet<ElementType>::find(Node* start, unsigned int key,
+    const ElementType* element, std::atomic<Node*>*& previous,
+    Node*& current) const
+{
+retry:
+    previous = &start->next;
+    current = unmarked(previous->load());
+
+    while(current != nullptr) {
+
+        Node* next = current->next.load();
+
+        if(previous->load() != current) {
+
+            goto retry;
+        }
+
+        if(isMarked(next)) {
+
+            Node* expected = current;
+            if(!previous->compare_exchange_strong(expected, unmarked(next))) {
+
+                goto retry;
+            }
+
+            reclaimer.retire(current, [](void* p) {
+                destroyNode(static_cast<Node*>(p)); });
+            current = unmarked(next);
+
+            continue;
+        }
+
+        if(current->key > key) {
+
+            return false;
+        }
+
+        if(current->key == key && (element == nullptr ||
+            static_cast<ElementNode*>(current)->value == *element)) {
+
+            return true;
+        }
+
+        previous = &current->next;
+        current = next;
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+bool LockFreeHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void LockFreeHashSet<ElementType>::add(const ElementType& element)
+{
+    insert(element);
+}
+
+
+template <typename ElementType>
+bool LockFreeHashSet<ElementType>::insert(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    unsigned int key = reverseBits(hash | 0x80000000u);
+
+    EpochReclaimer::Guard guard{ reclaimer };
+
+    unsigned int buckets = capacity.load();
+    Node* start = bucketHead(hash & (buckets - 1));
+
+    std::atomic<Node*>* previous = nullptr;
+    Node* current = nullptr;
+    ElementNode* node = nullptr;
+
+    while(true) {
+
+        if(find(start, key, &element, previous, current)) {
+
+            delete node;
+            return false;
+        }
+
+        if(node == nullptr) {
+
+            node = new ElementNode{ { { nullptr }, key }, element };
+        }
+
+        node->next.store(current, std::memory_order_relaxed);
+
+        if(previous->compare_exchange_strong(current, node)) {
+
+            break;
+        }
+    }
+
+    if(sz.fetch_add(1) + 1 > buckets * DEFAULT_MAX_LOAD && buckets < (1u << 31)) {
+
+        capacity.compare_exchange_strong(buckets, buckets * 2);
+    }
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool LockFreeHashSet<ElementType>::remove(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    unsigned int key = reverseBits(hash | 0x80000000u);
+
+    EpochReclaimer::Guard guard{ reclaimer };
+
+    Node* start = bucketHead(hash & (capacity.load() - 1));
+    std::atomic<Node*>* previous = nullptr;
+    Node* current = nullptr;
+
+    while(true) {
+
+        if(!find(start, key, &element, previous, current)) {
+
+            return false;
+        }
+
+        Node* next = current->next.load();
+
+        if(isMarked(next)) {
+
+            continue;
+        }
+
+        if(current->next.compare_exchange_strong(next, marked(next))) {
+
+            sz.fetch_sub(1);
+
+            Node* expected = current;
+            if(previous->compare_exchange_strong(expected, next)) {
+
+                reclaimer.retire(current, [](void* p) {
+                    destroyNode(static_cast<Node*>(p)); });
+            }
+            else {
+
+                find(start, key, &element, previous, current);
+            }
+
+            return true;
+        }
+    }
+}
+
+
+template <typename ElementType>
+bool LockFreeHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int hash = hashFunction(element);
+    unsigned int key = reverseBits(hash | 0x80000000u);
+
+    EpochReclaimer::Guard guard{ reclaimer };
+
+    Node* start = bucketHead(hash & (capacity.load() - 1));
+    std::atomic<Node*>* previous = nullptr;
+    Node* current = nullptr;
+
+    return find(start, key, &element, previous, current);
+}
+
+
+template <typename ElementType>
+unsigned int LockFreeHashSet<ElementType>::size() const noexcept
+{
+    return sz.load();
+}
+
+
+template <typename ElementType>
+unsigned int LockFreeHashSet<ElementType>::bucketCount() const noexcept
+{
+    return capacity.load();
+}
+
+#endif // LOCK_FREE_HASH_SET_HPP
@@ -0,0 +1,519 @@
+// Lru_Hash_Set.hpp
+#ifndef LRU_HASH_SET_HPP
+#define LRU_HASH_SET_HPP
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "Hash_Map.hpp"
+
+template <typename ElementType>
+class ConcurrentLruHashSet;
+
+
+// Capacity-bounded set that forgets its least recently used element, for
+// dedupe caches. Every element's entry carries intrusive links into a
+// recency list, so insert() finds or places the element with one probe of
+// the HashSet engine and refreshing or evicting it is a handful of pointer
+// writes. Entries are never stored inline, since the links point at them.
+//
+// insert() and touch() count as uses; contains() does not.
+template <typename ElementType>
+class LruHashSet : public Set<ElementType>
+{
+public:
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    LruHashSet(HashFunction hashFunction, unsigned int capacity);
+    ~LruHashSet() noexcept override;
+
+    LruHashSet(const LruHashSet& s) = delete;
+    LruHashSet& operator=(const LruHashSet& s) = delete;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+
+    // Returns true when the element was not present. When that takes the set
+    // past its capacity, the least recently used element is evicted.
+    bool insert(const ElementType& element);
+
+    // Marks the element as just used and returns whether it is present.
+    bool touch(const ElementType& element);
+
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int capacity() const noexcept;
+    unsigned long long evictionCount() const noexcept;
+    HashSetStatistics statistics() const;
+
+private:
+    struct Entry {
+
+        Entry(const ElementType& element, unsigned int hash);
+
+        ElementType element;
+        unsigned int hash;
+        Entry* older;
+        Entry* newer;
+    };
+
+    struct EntryKey {
+
+        using KeyType = ElementType;
+
+        static constexpr unsigned int INLINE_CAPACITY = 0;
+
+        static const KeyType& key(const Entry& entry) noexcept
+        {
+            return entry.element;
+        }
+    };
+
+    impl_::HashTable<Entry, EntryKey> table;
+    unsigned int limit;
+    unsigned long long evictions;
+    Entry* newest;
+    Entry* oldest;
+
+    bool insertHashed(unsigned int hash, const ElementType& element);
+    bool touchHashed(unsigned int hash, const ElementType& element);
+    bool removeHashed(unsigned int hash, const ElementType& element);
+
+    void link(Entry& entry) noexcept;
+    void unlink(Entry& entry) noexcept;
+
+    friend class ConcurrentLruHashSet<ElementType>;
+};
+
+
+// LruHashSet split into independently locked shards. The element's hash is
+// computed once and picks both the shard and the bucket within it. Each
+// shard evicts its own least recently used element, so recency is only
+// tracked per shard and capacity is divided evenly among the shards.
+template <typename ElementType>
+class ConcurrentLruHashSet : public Set<ElementType>
+{
+public:
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    ConcurrentLruHashSet(HashFunction hashFunction, unsigned int capacity,
+        unsigned int shardCount = 0);
+    ~ConcurrentLruHashSet() noexcept override;
+
+    ConcurrentLruHashSet(const ConcurrentLruHashSet& s) = delete;
+    ConcurrentLruHashSet& operator=(const ConcurrentLruHashSet& s) = delete;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+    bool insert(const ElementType& element);
+    bool touch(const ElementType& element);
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int capacity() const noexcept;
+    unsigned int shardCount() const noexcept;
+    unsigned long long evictionCount() const noexcept;
+
+private:
+    // Lookups refresh recency and so write to the shard; a plain mutex is
+    // cheaper than a shared one here.
+    struct alignas(64) Shard {
+
+        Shard(const HashFunction& hashFunction, unsigned int capacity);
+
+        mutable std::mutex lock;
+        LruHashSet<ElementType> set;
+    };
+
+    HashFunction hashFunction;
+    std::unique_ptr<std::unique_ptr<Shard>[]> shards;
+    unsigned int shardMask;
+    unsigned int limit;
+
+    Shard& shardOf(unsigned int hash) const noexcept;
+};
+
+
+template <typename ElementType>
+LruHashSet<ElementType>::Entry::Entry(const ElementType& element,
+    unsigned int hash)
+    : element{ element }, hash{ hash }, older{ nullptr }, newer{ nullptr }
+{
+}
+
+
+template <typename ElementType>
+LruHashSet<ElementType>::LruHashSet(HashFunction hashFunction,
+    unsigned int capacity)
+    : table{ hashFunction }, limit{ capacity }, evictions{ 0 },
+      newest{ nullptr }, oldest{ nullptr }
+{
+    if(capacity == 0) {
+
+        throw std::invalid_argument{ "Capacity must be positive!" };
+    }
+}
+
+
+template <typename ElementType>
+LruHashSet<ElementType>::~LruHashSet() noexcept
+{
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void LruHashSet<ElementType>::add(const ElementType& element)
+{
+    insert(element);
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::insert(const ElementType& element)
+{
+    return insertHashed(table.hash(element), element);
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::touch(const ElementType& element)
+{
+    return touchHashed(table.hash(element), element);
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::remove(const ElementType& element)
+{
+    return removeHashed(table.hash(element), element);
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::contains(const ElementType& element) const
+{
+    return table.contains(element);
+}
+
+
+template <typename ElementType>
+unsigned int LruHashSet<ElementType>::size() const noexcept
+{
+    return table.size();
+}
+
+
+template <typename ElementType>
+unsigned int LruHashSet<ElementType>::capacity() const noexcept
+{
+    return limit;
+}
+
+
+template <typename ElementType>
+unsigned long long LruHashSet<ElementType>::evictionCount() const noexcept
+{
+    return evictions;
+}
+
+
+template <typename ElementType>
+HashSetStatistics LruHashSet<ElementType>::statistics() const
+{
+    return table.statistics();
+}
+
+
+// The new element is placed before the oldest one is evicted, so the table
+// briefly holds capacity + 1 entries but a present element costs no
+// second probe.
+template <typename ElementType>
+bool LruHashSet<ElementType>::insertHashed(unsigned int hash,
+    const ElementType& element)
+{
+    auto result = table.emplace(hash, element, element, hash);
+    Entry& entry = *result.first;
+
+    if(!result.second) {
+
+        unlink(entry);
+        link(entry);
+
+        return false;
+    }
+
+    link(entry);
+
+    if(table.size() > limit) {
+
+        Entry* evicted = oldest;
+        unlink(*evicted);
+        table.removeHashed(evicted->hash, evicted->element);
+        evictions++;
+    }
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::touchHashed(unsigned int hash,
+    const ElementType& element)
+{
+    auto found = table.findHashed(hash, element);
+
+    if(found == table.end()) {
+
+        return false;
+    }
+
+    unlink(*found);
+    link(*found);
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool LruHashSet<ElementType>::removeHashed(unsigned int hash,
+    const ElementType& element)
+{
+    auto found = table.findHashed(hash, element);
+
+    if(found == table.end()) {
+
+        return false;
+    }
+
+    unlink(*found);
+
+    return table.removeHashed(hash, element);
+}
+
+
+// Makes entry the newest.
+template <typename ElementType>
+void LruHashSet<ElementType>::link(Entry& entry) noexcept
+{
+    entry.older = newest;
+    entry.newer = nullptr;
+
+    if(newest != nullptr) {
+
+        newest->newer = &entry;
+    }
+    else {
+
+        oldest = &entry;
+    }
+
+    newest = &entry;
+}
+
+
+template <typename ElementType>
+void LruHashSet<ElementType>::unlink(Entry& entry) noexcept
+{
+    if(entry.newer != nullptr) {
+
+        entry.newer->older = entry.older;
+    }
+    else {
+
+        newest = entry.older;
+    }
+
+    if(entry.older != nullptr) {
+
+        entry.older->newer = entry.newer;
+    }
+    else {
+
+        oldest = entry.newer;
+    }
+}
+
+
+template <typename ElementType>
+ConcurrentLruHashSet<ElementType>::Shard::Shard(
+    const HashFunction& hashFunction, unsigned int capacity)
+    : set{ hashFunction, capacity }
+{
+}
+
+
+template <typename ElementType>
+ConcurrentLruHashSet<ElementType>::ConcurrentLruHashSet(
+    HashFunction hashFunction, unsigned int capacity, unsigned int shardCount)
+    : hashFunction{ hashFunction }, shards{ nullptr }, shardMask{ 0 },
+      limit{ 0 }
+{
+    if(capacity == 0) {
+
+        throw std::invalid_argument{ "Capacity must be positive!" };
+    }
+
+    if(shardCount == 0) {
+
+        shardCount = std::thread::hardware_concurrency() * 4;
+    }
+
+    unsigned int count = 1;
+    while(count < shardCount && count < capacity) {
+
+        count <<= 1;
+    }
+
+    if(count > capacity) {
+
+        count >>= 1;
+    }
+
+    unsigned int perShard = capacity / count;
+
+    shards.reset(new std::unique_ptr<Shard>[count]);
+    for(unsigned int i = 0; i < count; ++i) {
+
+        shards[i].reset(new Shard{ hashFunction, perShard });
+    }
+
+    shardMask = count - 1;
+    limit = perShard * count;
+}
+
+
+template <typename ElementType>
+ConcurrentLruHashSet<ElementType>::~ConcurrentLruHashSet() noexcept
+{
+}
+
+
+template <typename ElementType>
+typename ConcurrentLruHashSet<ElementType>::Shard&
+    ConcurrentLruHashSet<ElementType>::shardOf(unsigned int hash) const noexcept
+{
+    return *shards[impl_::HashTable__shardIndex(hash, shardMask)];
+}
+
+
+template <typename ElementType>
+bool ConcurrentLruHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void ConcurrentLruHashSet<ElementType>::add(const ElementType& element)
+{
+    insert(element);
+}
+
+
+template <typename ElementType>
+bool ConcurrentLruHashSet<ElementType>::insert(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> guard{ shard.lock };
+
+    return shard.set.insertHashed(hash, element);
+}
+
+
+template <typename ElementType>
+bool ConcurrentLruHashSet<ElementType>::touch(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> guard{ shard.lock };
+
+    return shard.set.touchHashed(hash, element);
+}
+
+
+template <typename ElementType>
+bool ConcurrentLruHashSet<ElementType>::remove(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> guard{ shard.lock };
+
+    return shard.set.removeHashed(hash, element);
+}
+
+
+template <typename ElementType>
+bool ConcurrentLruHashSet<ElementType>::contains(
+    const ElementType& element) const
+{
+    unsigned int hash = hashFunction(element);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> guard{ shard.lock };
+
+    return shard.set.table.containsHashed(hash, element);
+}
+
+
+// Shards are read one at a time, so the total is only exact when no writer
+// runs concurrently.
+template <typename ElementType>
+unsigned int ConcurrentLruHashSet<ElementType>::size() const noexcept
+{
+    unsigned int total = 0;
+
+    for(unsigned int i = 0; i <= shardMask; ++i) {
+
+        std::lock_guard<std::mutex> guard{ shards[i]->lock };
+        total += shards[i]->set.size();
+    }
+
+    return total;
+}
+
+
+// May be less than the capacity asked for, which is rounded down to a
+// multiple of the shard count.
+template <typename ElementType>
+unsigned int ConcurrentLruHashSet<ElementType>::capacity() const noexcept
+{
+    return limit;
+}
+
+
+template <typename ElementType>
+unsigned int ConcurrentLruHashSet<ElementType>::shardCount() const noexcept
+{
+    return shardMask + 1;
+}
+
+
+template <typename ElementType>
+unsigned long long ConcurrentLruHashSet<ElementType>::evictionCount()
+    const noexcept
+{
+    unsigned long long total = 0;
+
+    for(unsigned int i = 0; i <= shardMask; ++i) {
+
+        std::lock_guard<std::mutex> guard{ shards[i]->lock };
+        total += shards[i]->set.evictionCount();
+    }
+
+    return total;
+}
+
+#endif // LRU_HASH_SET_HPP
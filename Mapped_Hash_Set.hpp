@@ -0,0 +1,368 @@
+// Mapped_Hash_Set.hpp
+#ifndef MAPPED_HASH_SET_HPP
+#define MAPPED_HASH_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Hash_Map.hpp"
+
+namespace impl_
+{
+    // Describes how an element is laid out in a mapped file. Trivially
+    // copyable elements are stored as they are.
+    template <typename ElementType>
+    struct MappedHashSet__codec
+    {
+        static_assert(std::is_trivially_copyable<ElementType>::value,
+            "MappedHashSet needs trivially copyable elements or std::string");
+
+        using Stored = ElementType;
+
+        static Stored store(const ElementType& element, std::vector<char>&)
+        {
+            return element;
+        }
+
+        static bool equals(const Stored& stored, const char*, std::uint64_t,
+            const ElementType& element)
+        {
+            return stored == element;
+        }
+    };
+
+
+    // Strings are stored as an offset and a length into the string heap that
+    // follows the slot array. Both come from the file, so they are checked
+    // against the heap's size before any byte is read.
+    template <>
+    struct MappedHashSet__codec<std::string>
+    {
+        struct Stored {
+
+            std::uint64_t offset;
+            std::uint64_t length;
+        };
+
+        static Stored store(const std::string& element, std::vector<char>& heap)
+        {
+            Stored stored{ heap.size(), element.size() };
+            heap.insert(heap.end(), element.begin(), element.end());
+
+            return stored;
+        }
+
+        static bool equals(const Stored& stored, const char* heap,
+            std::uint64_t heapSize, const std::string& element)
+        {
+            return stored.length == element.size() &&
+                stored.offset <= heapSize &&
+                stored.length <= heapSize - stored.offset &&
+                std::memcmp(heap + stored.offset, element.data(),
+                    element.size()) == 0;
+        }
+    };
+}
+
+
+// Read-only set that queries a file written by write() in place through
+// mmap, so opening it costs the same for ten elements as for a hundred
+// million, and processes mapping the same file share its page cache.
+//
+// The file holds a header, a linear-probing slot array and, for strings,
+// a heap of key bytes. Slots keep the element's hash, so the same hash
+// function must be passed when the file is opened. Files use the native
+// byte order and are rejected on a machine with a different one.
+template <typename ElementType>
+class MappedHashSet
+{
+public:
+    static constexpr std::uint64_t MAGIC = 0x31544553484d5348ULL;
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr double MAX_LOAD_FACTOR = 0.7;
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    MappedHashSet(const std::string& path, HashFunction hashFunction);
+    ~MappedHashSet() noexcept;
+
+    MappedHashSet(const MappedHashSet& s) = delete;
+    MappedHashSet(MappedHashSet&& s) noexcept;
+
+    MappedHashSet& operator=(const MappedHashSet& s) = delete;
+    MappedHashSet& operator=(MappedHashSet&& s) noexcept;
+
+    static void write(const HashSet<ElementType>& s, const std::string& path);
+
+    bool contains(const ElementType& element) const;
+    unsigned int size() const noexcept;
+    std::size_t bytesMapped() const noexcept;
+
+private:
+    using Codec = impl_::MappedHashSet__codec<ElementType>;
+
+    struct Header {
+
+        std::uint64_t magic;
+        std::uint32_t version;
+        std::uint32_t slotSize;
+        std::uint64_t count;
+        std::uint64_t slotCount;
+        std::uint64_t heapOffset;
+        std::uint64_t heapSize;
+    };
+
+    // occupied is kept apart from the hash so that every hash value stays
+    // usable.
+    struct Slot {
+
+        std::uint32_t hash;
+        std::uint32_t occupied;
+        typename Codec::Stored value;
+    };
+
+    static constexpr std::size_t SLOTS_OFFSET = 64;
+    static_assert(sizeof(Header) <= SLOTS_OFFSET, "Header outgrew its space");
+
+    HashFunction hashFunction;
+    void* mapping;
+    std::size_t length;
+    const Slot* slots;
+    const char* heap;
+    std::uint64_t heapSize;
+    std::uint64_t count;
+    std::uint64_t mask;
+
+    void unmap() noexcept;
+};
+
+
+// The file is written next to its destination and renamed into place, so a
+// reader never maps a half-written file.
+template <typename ElementType>
+void MappedHashSet<ElementType>::write(const HashSet<ElementType>& s,
+    const std::string& path)
+{
+    HashFunction hashFunction = s.hasher();
+
+    std::uint64_t slotCount = 1;
+    while(s.size() > slotCount * MAX_LOAD_FACTOR) {
+
+        slotCount <<= 1;
+    }
+
+    std::vector<Slot> slots(slotCount);
+    std::vector<char> heap;
+    std::uint64_t mask = slotCount - 1;
+
+    std::memset(slots.data(), 0, sizeof(Slot) * slots.size());
+
+    for(const ElementType& element : s) {
+
+        std::uint32_t hash = hashFunction(element);
+        std::uint64_t index = impl_::HashTable__mix(hash) & mask;
+
+        while(slots[index].occupied) {
+
+            index = (index + 1) & mask;
+        }
+
+        slots[index].hash = hash;
+        slots[index].occupied = 1;
+        slots[index].value = Codec::store(element, heap);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.slotSize = sizeof(Slot);
+    header.count = s.size();
+    header.slotCount = slotCount;
+    header.heapOffset = SLOTS_OFFSET + sizeof(Slot) * slotCount;
+    header.heapSize = heap.size();
+
+    char padding[SLOTS_OFFSET] = {};
+    std::string temporary = path + ".tmp";
+    std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(padding, SLOTS_OFFSET - sizeof(header));
+    out.write(reinterpret_cast<const char*>(slots.data()),
+        sizeof(Slot) * slots.size());
+    out.write(heap.data(), heap.size());
+    out.close();
+
+    if(!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+
+        std::remove(temporary.c_str());
+        throw std::runtime_error{ "Could not write the mapped hash set!" };
+    }
+}
+
+
+template <typename ElementType>
+MappedHashSet<ElementType>::MappedHashSet(const std::string& path,
+    HashFunction hashFunction)
+    : hashFunction{ hashFunction }, mapping{ nullptr }, length{ 0 },
+      slots{ nullptr }, heap{ nullptr }, heapSize{ 0 }, count{ 0 },
+      mask{ 0 }
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0) {
+
+        throw std::runtime_error{ "Could not open the mapped hash set!" };
+    }
+
+    struct stat status;
+    if(::fstat(fd, &status) != 0 ||
+        static_cast<std::size_t>(status.st_size) < SLOTS_OFFSET) {
+
+        ::close(fd);
+        throw std::runtime_error{ "Mapped hash set file is truncated!" };
+    }
+
+    length = static_cast<std::size_t>(status.st_size);
+    mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(mapping == MAP_FAILED) {
+
+        mapping = nullptr;
+        throw std::runtime_error{ "Could not map the mapped hash set!" };
+    }
+
+    // The slot count is bounded by the file length before it is multiplied,
+    // so a crafted header cannot overflow the size checks.
+    const Header& header = *static_cast<const Header*>(mapping);
+
+    if(header.magic != MAGIC || header.version != VERSION ||
+        header.slotSize != sizeof(Slot) || header.slotCount == 0 ||
+        (header.slotCount & (header.slotCount - 1)) != 0 ||
+        header.slotCount > (length - SLOTS_OFFSET) / sizeof(Slot) ||
+        header.heapOffset != SLOTS_OFFSET + sizeof(Slot) * header.slotCount ||
+        header.heapSize != length - header.heapOffset ||
+        header.count >= header.slotCount) {
+
+        unmap();
+        throw std::runtime_error{ "Not a compatible mapped hash set file!" };
+    }
+
+    slots = reinterpret_cast<const Slot*>(
+        static_cast<const char*>(mapping) + SLOTS_OFFSET);
+    heap = static_cast<const char*>(mapping) + header.heapOffset;
+    heapSize = header.heapSize;
+    count = header.count;
+    mask = header.slotCount - 1;
+}
+
+
+template <typename ElementType>
+MappedHashSet<ElementType>::~MappedHashSet() noexcept
+{
+    unmap();
+}
+
+
+template <typename ElementType>
+MappedHashSet<ElementType>::MappedHashSet(MappedHashSet&& s) noexcept
+    : hashFunction{ s.hashFunction }, mapping{ s.mapping }, length{ s.length },
+      slots{ s.slots }, heap{ s.heap }, heapSize{ s.heapSize },
+      count{ s.count }, mask{ s.mask }
+{
+    s.mapping = nullptr;
+    s.length = 0;
+    s.slots = nullptr;
+    s.count = 0;
+}
+
+
+template <typename ElementType>
+MappedHashSet<ElementType>& MappedHashSet<ElementType>::operator=(
+    MappedHashSet&& s) noexcept
+{
+    if(this != &s) {
+
+        std::swap(hashFunction, s.hashFunction);
+        std::swap(mapping, s.mapping);
+        std::swap(length, s.length);
+        std::swap(slots, s.slots);
+        std::swap(heap, s.heap);
+        std::swap(heapSize, s.heapSize);
+        std::swap(count, s.count);
+        std::swap(mask, s.mask);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+void MappedHashSet<ElementType>::unmap() noexcept
+{
+    if(mapping != nullptr) {
+
+        ::munmap(mapping, length);
+    }
+
+    mapping = nullptr;
+    length = 0;
+}
+
+
+template <typename ElementType>
+bool MappedHashSet<ElementType>::contains(const ElementType& element) const
+{
+    if(slots == nullptr) {
+
+        return false;
+    }
+
+    std::uint32_t hash = hashFunction(element);
+    std::uint64_t index = impl_::HashTable__mix(hash) & mask;
+
+    // write() always leaves a slot empty. The probe count is bounded anyway,
+    // so a file with every slot occupied cannot make a miss spin forever.
+    for(std::uint64_t probe = 0; probe <= mask && slots[index].occupied;
+        ++probe) {
+
+        const Slot& slot = slots[index];
+
+        if(slot.hash == hash &&
+            Codec::equals(slot.value, heap, heapSize, element)) {
+
+            return true;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+unsigned int MappedHashSet<ElementType>::size() const noexcept
+{
+    return static_cast<unsigned int>(count);
+}
+
+
+template <typename ElementType>
+std::size_t MappedHashSet<ElementType>::bytesMapped() const noexcept
+{
+    return length;
+}
+
+#endif // MAPPED_HASH_SET_HPP
@@ -0,0 +1,293 @@
+// Read_Mostly_Hash_Set.hpp
+#ifndef READ_MOSTLY_HASH_SET_HPP
+#define READ_MOSTLY_HASH_SET_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "Epoch_Reclamation.hpp"
+#include "Hash_Map.hpp"
+
+// Chained hash set for read-mostly use, in the style of RCU. Readers never
+// take a lock: they enter an epoch, load the published table pointer and
+// walk its chains, which writers only ever change by swinging a single
+// atomic link. Writers are serialized by a mutex.
+//
+// Growing does not relink nodes under readers' feet. The writer copies
+// every element into a new table, publishes it with one atomic store and
+// retires the old table, which is freed once no reader can still be in it.
+// Removed nodes are retired the same way. Memory for the old table is
+// therefore held a little longer than the resize itself.
+template <typename ElementType>
+class ReadMostlyHashSet : public Set<ElementType>
+{
+public:
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+    static constexpr double MAX_LOAD_FACTOR = 1.0;
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    explicit ReadMostlyHashSet(HashFunction hashFunction);
+    ~ReadMostlyHashSet() noexcept override;
+
+    ReadMostlyHashSet(const ReadMostlyHashSet& s) = delete;
+    ReadMostlyHashSet& operator=(const ReadMostlyHashSet& s) = delete;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+    bool insert(const ElementType& element);
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int bucketCount() const noexcept;
+    void reserve(unsigned int count);
+
+private:
+    struct Node {
+
+        Node(const ElementType& value, unsigned int hash, Node* next);
+
+        ElementType value;
+        unsigned int hash;
+        std::atomic<Node*> next;
+    };
+
+    // Owns its chains, so retiring a table also frees the nodes that were
+    // still linked into it.
+    struct Table {
+
+        explicit Table(unsigned int capacity);
+        ~Table() noexcept;
+
+        unsigned int capacity;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+
+    HashFunction hashFunction;
+    std::atomic<Table*> current;
+    std::atomic<unsigned int> sz;
+    std::mutex writing;
+    mutable EpochReclaimer reclaimer;
+
+    static Node* find(const Table& table, unsigned int hash,
+        const ElementType& element) noexcept;
+    void resize(unsigned int newCapacity);
+};
+
+
+template <typename ElementType>
+ReadMostlyHashSet<ElementType>::Node::Node(const ElementType& value,
+    unsigned int hash, Node* next)
+    : value{ value }, hash{ hash }, next{ next }
+{
+}
+
+
+template <typename ElementType>
+ReadMostlyHashSet<ElementType>::Table::Table(unsigned int capacity)
+    : capacity{ capacity }, buckets{ new std::atomic<Node*>[capacity] }
+{
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+
+template <typename ElementType>
+ReadMostlyHashSet<ElementType>::Table::~Table() noexcept
+{
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        Node* current = buckets[i].load(std::memory_order_relaxed);
+
+        while(current != nullptr) {
+
+            Node* next = current->next.load(std::memory_order_relaxed);
+            delete current;
+            current = next;
+        }
+    }
+}
+
+
+template <typename ElementType>
+ReadMostlyHashSet<ElementType>::ReadMostlyHashSet(HashFunction hashFunction)
+    : hashFunction{ hashFunction }, current{ nullptr }, sz{ 0 }
+{
+    current.store(new Table{ DEFAULT_CAPACITY });
+}
+
+
+template <typename ElementType>
+ReadMostlyHashSet<ElementType>::~ReadMostlyHashSet() noexcept
+{
+    delete current.load();
+}
+
+
+template <typename ElementType>
+bool ReadMostlyHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void ReadMostlyHashSet<ElementType>::add(const ElementType& element)
+{
+    insert(element);
+}
+
+
+template <typename ElementType>
+typename ReadMostlyHashSet<ElementType>::Node*
+    ReadMostlyHashSet<ElementType>::find(const Table& table, unsigned int hash,
+    const ElementType& element) noexcept
+{
+    Node* current =
+        table.buckets[hash % table.capacity].load(std::memory_order_acquire);
+
+    while(current != nullptr &&
+        !(current->hash == hash && current->value == element)) {
+
+        current = current->next.load(std::memory_order_acquire);
+    }
+
+    return current;
+}
+
+
+// Builds the new table completely before publishing it, so a reader sees
+// either the old table or the new one, never a half-filled one.
+template <typename ElementType>
+void ReadMostlyHashSet<ElementType>::resize(unsigned int newCapacity)
+{
+    Table* old = current.load(std::memory_order_relaxed);
+    std::unique_ptr<Table> fresh{ new Table{ newCapacity } };
+
+    for(unsigned int i = 0; i < old->capacity; ++i) {
+
+        for(Node* node = old->buckets[i].load(std::memory_order_relaxed);
+            node != nullptr; node = node->next.load(std::memory_order_relaxed)) {
+
+            std::atomic<Node*>& head = fresh->buckets[node->hash % newCapacity];
+            head.store(new Node{ node->value, node->hash,
+                head.load(std::memory_order_relaxed) },
+                std::memory_order_relaxed);
+        }
+    }
+
+    current.store(fresh.release(), std::memory_order_release);
+    reclaimer.retire(old);
+}
+
+
+template <typename ElementType>
+bool ReadMostlyHashSet<ElementType>::insert(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    std::lock_guard<std::mutex> lock{ writing };
+
+    Table* table = current.load(std::memory_order_relaxed);
+
+    if(find(*table, hash, element) != nullptr) {
+
+        return false;
+    }
+
+    if(sz.load(std::memory_order_relaxed) + 1 >
+        table->capacity * MAX_LOAD_FACTOR) {
+
+        resize(table->capacity * 2);
+        table = current.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<Node*>& head = table->buckets[hash % table->capacity];
+    head.store(new Node{ element, hash, head.load(std::memory_order_relaxed) },
+        std::memory_order_release);
+    sz.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+
+// Unlinking is a single store into the predecessor's link. A reader already
+// standing on the removed node still finds its next pointer intact.
+template <typename ElementType>
+bool ReadMostlyHashSet<ElementType>::remove(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    std::lock_guard<std::mutex> lock{ writing };
+
+    Table* table = current.load(std::memory_order_relaxed);
+    std::atomic<Node*>* link = &table->buckets[hash % table->capacity];
+
+    for(Node* node = link->load(std::memory_order_relaxed); node != nullptr;
+        node = link->load(std::memory_order_relaxed)) {
+
+        if(node->hash == hash && node->value == element) {
+
+            link->store(node->next.load(std::memory_order_relaxed),
+                std::memory_order_release);
+            sz.fetch_sub(1, std::memory_order_relaxed);
+            reclaimer.retire(node);
+
+            return true;
+        }
+
+        link = &node->next;
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+bool ReadMostlyHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int hash = hashFunction(element);
+    EpochReclaimer::Guard guard{ reclaimer };
+
+    return find(*current.load(std::memory_order_acquire), hash, element) !=
+        nullptr;
+}
+
+
+template <typename ElementType>
+unsigned int ReadMostlyHashSet<ElementType>::size() const noexcept
+{
+    return sz.load(std::memory_order_relaxed);
+}
+
+
+template <typename ElementType>
+unsigned int ReadMostlyHashSet<ElementType>::bucketCount() const noexcept
+{
+    EpochReclaimer::Guard guard{ reclaimer };
+
+    return current.load(std::memory_order_acquire)->capacity;
+}
+
+
+template <typename ElementType>
+void ReadMostlyHashSet<ElementType>::reserve(unsigned int count)
+{
+    std::lock_guard<std::mutex> lock{ writing };
+
+    unsigned int capacity = current.load(std::memory_order_relaxed)->capacity;
+    unsigned int newCapacity = capacity;
+
+    while(count > newCapacity * MAX_LOAD_FACTOR) {
+
+        newCapacity *= 2;
+    }
+
+    if(newCapacity != capacity) {
+
+        resize(newCapacity);
+    }
+}
+
+#endif // READ_MOSTLY_HASH_SET_HPP
@@ -0,0 +1,516 @@
+// Robin_Hood_Hash_Set.hpp
+#ifndef ROBIN_HOOD_HASH_SET_HPP
+#define ROBIN_HOOD_HASH_SET_HPP
+
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "Hash_Map.hpp"
+
+// Open-addressing set with Robin Hood probing. Every slot records how far
+// its element sits from its home slot; an insert takes the slot of any
+// element closer to home than itself, which keeps probe lengths short and
+// even at high load. Lookups stop as soon as they pass a slot whose element
+// is closer to home than the one being searched for, and removal shifts the
+// following run back instead of leaving tombstones.
+template <typename ElementType>
+class RobinHoodHashSet : public Set<ElementType>
+{
+public:
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.9;
+    using HashFunction = typename HashSet<ElementType>::HashFunction;
+
+public:
+    explicit RobinHoodHashSet(HashFunction hashFunction);
+    ~RobinHoodHashSet() noexcept override;
+
+    RobinHoodHashSet(const RobinHoodHashSet& s);
+    RobinHoodHashSet(RobinHoodHashSet&& s) noexcept;
+
+    RobinHoodHashSet& operator=(const RobinHoodHashSet& s);
+    RobinHoodHashSet& operator=(RobinHoodHashSet&& s) noexcept;
+
+    bool isImplemented() const noexcept override;
+    void add(const ElementType& element) override;
+    bool insert(const ElementType& element);
+    bool insert(ElementType&& element);
+    bool remove(const ElementType& element);
+    bool contains(const ElementType& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int bucketCount() const noexcept;
+    double loadFactor() const noexcept;
+    void maxLoadFactor(double factor);
+    void reserve(unsigned int count);
+
+    unsigned int maxProbeLength() const noexcept;
+    double meanProbeLength() const noexcept;
+
+private:
+    // distance counts the slots a lookup inspects to reach the element, so
+    // zero marks an empty slot.
+    struct Slot {
+
+        unsigned int hash;
+        unsigned int distance;
+    };
+
+    HashFunction hashFunction;
+    Slot* slots;
+    ElementType* values;
+    unsigned int sz, capacity;
+    double maxLoad;
+
+    void allocate(unsigned int newCapacity);
+    void destroyAll() noexcept;
+    void copyFrom(const RobinHoodHashSet& s);
+    void rehashTo(unsigned int newCapacity);
+    void place(unsigned int hash, ElementType&& element);
+    int findIndex(unsigned int hash, const ElementType& element) const;
+
+    template <typename Value>
+    bool insert_(Value&& element);
+};
+
+
+template <typename ElementType>
+RobinHoodHashSet<ElementType>::RobinHoodHashSet(HashFunction hashFunction)
+    : hashFunction{ hashFunction }, slots{ nullptr }, values{ nullptr },
+      sz{ 0 }, capacity{ 0 }, maxLoad{ DEFAULT_MAX_LOAD_FACTOR }
+{
+    allocate(DEFAULT_CAPACITY);
+}
+
+
+template <typename ElementType>
+RobinHoodHashSet<ElementType>::~RobinHoodHashSet() noexcept
+{
+    destroyAll();
+}
+
+
+template <typename ElementType>
+RobinHoodHashSet<ElementType>::RobinHoodHashSet(const RobinHoodHashSet& s)
+    : hashFunction{ s.hashFunction }, slots{ nullptr }, values{ nullptr },
+      sz{ 0 }, capacity{ 0 }, maxLoad{ s.maxLoad }
+{
+    copyFrom(s);
+}
+
+
+// Leaves s without a table. Every member treats capacity 0 as an empty set,
+// and the next insert allocates DEFAULT_CAPACITY slots.
+template <typename ElementType>
+RobinHoodHashSet<ElementType>::RobinHoodHashSet(RobinHoodHashSet&& s) noexcept
+    : hashFunction{ s.hashFunction }, slots{ nullptr }, values{ nullptr },
+      sz{ 0 }, capacity{ 0 }, maxLoad{ s.maxLoad }
+{
+    std::swap(slots, s.slots);
+    std::swap(values, s.values);
+    std::swap(sz, s.sz);
+    std::swap(capacity, s.capacity);
+}
+
+
+template <typename ElementType>
+RobinHoodHashSet<ElementType>& RobinHoodHashSet<ElementType>::operator=(
+    const RobinHoodHashSet& s)
+{
+    if(this != &s) {
+
+        RobinHoodHashSet copy{ s };
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+RobinHoodHashSet<ElementType>& RobinHoodHashSet<ElementType>::operator=(
+    RobinHoodHashSet&& s) noexcept
+{
+    if(this != &s) {
+
+        std::swap(hashFunction, s.hashFunction);
+        std::swap(slots, s.slots);
+        std::swap(values, s.values);
+        std::swap(sz, s.sz);
+        std::swap(capacity, s.capacity);
+        std::swap(maxLoad, s.maxLoad);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::allocate(unsigned int newCapacity)
+{
+    Slot* newSlots = new Slot[newCapacity]();
+
+    try {
+
+        values = static_cast<ElementType*>(
+            ::operator new(sizeof(ElementType) * newCapacity));
+    }
+    catch(...) {
+
+        delete[] newSlots;
+        throw;
+    }
+
+    slots = newSlots;
+    capacity = newCapacity;
+}
+
+
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::destroyAll() noexcept
+{
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        if(slots[i].distance != 0) {
+
+            values[i].~ElementType();
+        }
+    }
+
+    delete[] slots;
+    ::operator delete(values);
+
+    slots = nullptr;
+    values = nullptr;
+    sz = 0;
+    capacity = 0;
+}
+
+
+// Copies slot for slot, since the same hash function puts every element in
+// the same place.
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::copyFrom(const RobinHoodHashSet& s)
+{
+    allocate(s.capacity);
+
+    for(unsigned int i = 0; i < s.capacity; ++i) {
+
+        if(s.slots[i].distance != 0) {
+
+            try {
+
+                new (&values[i]) ElementType(s.values[i]);
+            }
+            catch(...) {
+
+                destroyAll();
+                throw;
+            }
+
+            slots[i] = s.slots[i];
+            sz++;
+        }
+    }
+}
+
+
+// Fills the new arrays before the old ones are released, moving only when
+// the move cannot throw. If placing throws, the new arrays are destroyed
+// and the old ones put back, so the set is left as it was.
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::rehashTo(unsigned int newCapacity)
+{
+    Slot* oldSlots = slots;
+    ElementType* oldValues = values;
+    unsigned int oldCapacity = capacity;
+    unsigned int oldSize = sz;
+
+    allocate(newCapacity);
+    sz = 0;
+
+    try {
+
+        for(unsigned int i = 0; i < oldCapacity; ++i) {
+
+            if(oldSlots[i].distance != 0) {
+
+                place(oldSlots[i].hash,
+                    ElementType(std::move_if_noexcept(oldValues[i])));
+            }
+        }
+    }
+    catch(...) {
+
+        destroyAll();
+
+        slots = oldSlots;
+        values = oldValues;
+        capacity = oldCapacity;
+        sz = oldSize;
+        throw;
+    }
+
+    for(unsigned int i = 0; i < oldCapacity; ++i) {
+
+        if(oldSlots[i].distance != 0) {
+
+            oldValues[i].~ElementType();
+        }
+    }
+
+    delete[] oldSlots;
+    ::operator delete(oldValues);
+}
+
+
+// Walks from the home slot, swapping the carried element with any resident
+// that is closer to its own home.
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::place(unsigned int hash,
+    ElementType&& element)
+{
+    unsigned int mask = capacity - 1;
+    unsigned int index = hash & mask;
+    unsigned int distance = 1;
+
+    while(true) {
+
+        Slot& slot = slots[index];
+
+        if(slot.distance == 0) {
+
+            new (&values[index]) ElementType(std::move(element));
+            slot.hash = hash;
+            slot.distance = distance;
+            sz++;
+
+            return;
+        }
+
+        if(slot.distance < distance) {
+
+            std::swap(values[index], element);
+            std::swap(slot.hash, hash);
+            std::swap(slot.distance, distance);
+        }
+
+        index = (index + 1) & mask;
+        distance++;
+    }
+}
+
+
+template <typename ElementType>
+int RobinHoodHashSet<ElementType>::findIndex(unsigned int hash,
+    const ElementType& element) const
+{
+    if(capacity == 0) {
+
+        return -1;
+    }
+
+    unsigned int mask = capacity - 1;
+    unsigned int index = hash & mask;
+
+    for(unsigned int distance = 1; ; ++distance) {
+
+        const Slot& slot = slots[index];
+
+        if(slot.distance < distance) {
+
+            return -1;
+        }
+
+        if(slot.hash == hash && values[index] == element) {
+
+            return static_cast<int>(index);
+        }
+
+        index = (index + 1) & mask;
+    }
+}
+
+
+template <typename ElementType>
+template <typename Value>
+bool RobinHoodHashSet<ElementType>::insert_(Value&& element)
+{
+    unsigned int hash = impl_::HashTable__mix(hashFunction(element));
+
+    if(findIndex(hash, element) >= 0) {
+
+        return false;
+    }
+
+    if(sz + 1 > capacity * maxLoad) {
+
+        rehashTo(capacity == 0 ? DEFAULT_CAPACITY : capacity * 2);
+    }
+
+    ElementType carried(std::forward<Value>(element));
+    place(hash, std::move(carried));
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool RobinHoodHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::add(const ElementType& element)
+{
+    insert_(element);
+}
+
+
+template <typename ElementType>
+bool RobinHoodHashSet<ElementType>::insert(const ElementType& element)
+{
+    return insert_(element);
+}
+
+
+template <typename ElementType>
+bool RobinHoodHashSet<ElementType>::insert(ElementType&& element)
+{
+    return insert_(std::move(element));
+}
+
+
+// Backward-shift deletion: every following element that is not in its home
+// slot moves back by one, so no tombstone is left behind.
+template <typename ElementType>
+bool RobinHoodHashSet<ElementType>::remove(const ElementType& element)
+{
+    unsigned int hash = impl_::HashTable__mix(hashFunction(element));
+    int found = findIndex(hash, element);
+
+    if(found < 0) {
+
+        return false;
+    }
+
+    unsigned int mask = capacity - 1;
+    unsigned int index = static_cast<unsigned int>(found);
+    unsigned int next = (index + 1) & mask;
+
+    while(slots[next].distance > 1) {
+
+        values[index] = std::move(values[next]);
+        slots[index].hash = slots[next].hash;
+        slots[index].distance = slots[next].distance - 1;
+
+        index = next;
+        next = (next + 1) & mask;
+    }
+
+    values[index].~ElementType();
+    slots[index].distance = 0;
+    sz--;
+
+    return true;
+}
+
+
+template <typename ElementType>
+bool RobinHoodHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int hash = impl_::HashTable__mix(hashFunction(element));
+
+    return findIndex(hash, element) >= 0;
+}
+
+
+template <typename ElementType>
+unsigned int RobinHoodHashSet<ElementType>::size() const noexcept
+{
+    return sz;
+}
+
+
+template <typename ElementType>
+unsigned int RobinHoodHashSet<ElementType>::bucketCount() const noexcept
+{
+    return capacity;
+}
+
+
+template <typename ElementType>
+double RobinHoodHashSet<ElementType>::loadFactor() const noexcept
+{
+    return capacity == 0 ? 0.0 : static_cast<double>(sz) / capacity;
+}
+
+
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::maxLoadFactor(double factor)
+{
+    if(!(factor > 0.0 && factor < 1.0)) {
+
+        throw std::invalid_argument{ "Max load factor must be in (0, 1)!" };
+    }
+
+    maxLoad = factor;
+    reserve(sz);
+}
+
+
+template <typename ElementType>
+void RobinHoodHashSet<ElementType>::reserve(unsigned int count)
+{
+    unsigned int newCapacity = capacity == 0 ? DEFAULT_CAPACITY : capacity;
+
+    while(count > newCapacity * maxLoad) {
+
+        newCapacity *= 2;
+    }
+
+    if(newCapacity != capacity) {
+
+        rehashTo(newCapacity);
+    }
+}
+
+
+template <typename ElementType>
+unsigned int RobinHoodHashSet<ElementType>::maxProbeLength() const noexcept
+{
+    unsigned int longest = 0;
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        if(slots[i].distance > longest) {
+
+            longest = slots[i].distance;
+        }
+    }
+
+    return longest;
+}
+
+
+template <typename ElementType>
+double RobinHoodHashSet<ElementType>::meanProbeLength() const noexcept
+{
+    if(sz == 0) {
+
+        return 0.0;
+    }
+
+    unsigned long long total = 0;
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        total += slots[i].distance;
+    }
+
+    return static_cast<double>(total) / sz;
+}
+
+#endif // ROBIN_HOOD_HASH_SET_HPP
@@ -0,0 +1,405 @@
+// Seeded_String_Hashing.hpp
+#ifndef SEEDED_STRING_HASHING_HPP
+#define SEEDED_STRING_HASHING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STRING_HASHING_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+// Seeded string hashes that plug into HashSet::HashFunction.
+//
+// seededHash is a wyhash-style multiply-fold hash for short keys. Keys of
+// 256 bytes and more first run through an xxh3-style eight-lane
+// accumulator, which uses AVX2 when the CPU has it. Both paths give
+// identical results on every machine of the same byte order, so hashes
+// may be stored. With a secret seed an attacker cannot precompute
+// colliding keys; SeededStringHash draws a fresh seed per table.
+//
+// crc32cHash uses the SSE4.2 CRC32 instruction with a table fallback. It
+// is fast but linear in its input, so it offers no flooding protection
+// and should only be used on trusted keys.
+
+inline std::uint64_t randomHashSeed();
+inline std::uint64_t seededHash64(const void* data, std::size_t length,
+    std::uint64_t seed) noexcept;
+inline unsigned int seededHash(const std::string& key,
+    std::uint64_t seed) noexcept;
+inline unsigned int crc32cHash(const std::string& key,
+    std::uint32_t seed = 0) noexcept;
+
+
+class SeededStringHash
+{
+public:
+    explicit SeededStringHash(std::uint64_t seed = randomHashSeed()) noexcept;
+
+    unsigned int operator()(const std::string& key) const noexcept;
+    std::uint64_t seed() const noexcept;
+
+private:
+    std::uint64_t hashSeed;
+};
+
+
+namespace impl_
+{
+    constexpr std::size_t StringHash__LONG_KEY_THRESHOLD = 256;
+    constexpr std::size_t StringHash__STRIPE = 64;
+    constexpr std::uint64_t StringHash__P0 = 0xa0761d6478bd642fULL;
+    constexpr std::uint64_t StringHash__P1 = 0xe7037ed1a0b428dbULL;
+    constexpr std::uint64_t StringHash__P2 = 0x8ebc6af09c88c6e3ULL;
+
+
+    inline std::uint64_t StringHash__read64(const unsigned char* p) noexcept
+    {
+        std::uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+
+        return value;
+    }
+
+
+    inline std::uint64_t StringHash__read32(const unsigned char* p) noexcept
+    {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+
+        return value;
+    }
+
+
+    // 64x64->128 multiply folded back to 64 bits.
+    inline std::uint64_t StringHash__mum(std::uint64_t a, std::uint64_t b) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        // __extension__ keeps -Wpedantic quiet about the non-standard type.
+        __extension__ typedef unsigned __int128 Wide;
+        Wide product = static_cast<Wide>(a) * b;
+
+        return static_cast<std::uint64_t>(product) ^
+            static_cast<std::uint64_t>(product >> 64);
+#else
+        std::uint64_t aLow = a & 0xffffffffu, aHigh = a >> 32;
+        std::uint64_t bLow = b & 0xffffffffu, bHigh = b >> 32;
+        std::uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh;
+        std::uint64_t highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+        std::uint64_t middle = (lowLow >> 32) + (lowHigh & 0xffffffffu) +
+            (highLow & 0xffffffffu);
+        std::uint64_t low = (lowLow & 0xffffffffu) | (middle << 32);
+        std::uint64_t high = highHigh + (lowHigh >> 32) + (highLow >> 32) +
+            (middle >> 32);
+
+        return low ^ high;
+#endif
+    }
+
+
+    inline std::uint64_t StringHash__splitmix(std::uint64_t x) noexcept
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+        return x ^ (x >> 31);
+    }
+
+
+    inline std::uint64_t StringHash__short(const unsigned char* p,
+        std::size_t length, std::uint64_t seed) noexcept
+    {
+        std::uint64_t a, b;
+        seed ^= StringHash__mum(seed ^ StringHash__P0, StringHash__P1);
+
+        if(length <= 16) {
+
+            if(length >= 4) {
+
+                std::size_t shift = (length >> 3) << 2;
+                a = (StringHash__read32(p) << 32) | StringHash__read32(p + shift);
+                b = (StringHash__read32(p + length - 4) << 32) |
+                    StringHash__read32(p + length - 4 - shift);
+            }
+            else if(length > 0) {
+
+                a = (static_cast<std::uint64_t>(p[0]) << 16) |
+                    (static_cast<std::uint64_t>(p[length >> 1]) << 8) |
+                    p[length - 1];
+                b = 0;
+            }
+            else {
+
+                a = b = 0;
+            }
+        }
+        else {
+
+            std::size_t left = length;
+            const unsigned char* q = p;
+
+            while(left > 16) {
+
+                seed = StringHash__mum(StringHash__read64(q) ^ StringHash__P1,
+                    StringHash__read64(q + 8) ^ seed);
+                q += 16;
+                left -= 16;
+            }
+
+            a = StringHash__read64(p + length - 16);
+            b = StringHash__read64(p + length - 8);
+        }
+
+        return StringHash__mum(StringHash__P1 ^ length,
+            StringHash__mum(a ^ StringHash__P1, b ^ seed));
+    }
+
+
+    // Each lane adds the neighbouring lane's input plus the product of the
+    // two halves of its own input xored with the secret.
+    inline void StringHash__accumulateScalar(std::uint64_t* accumulators,
+        const unsigned char* p, std::size_t stripes,
+        const std::uint64_t* secret) noexcept
+    {
+        for(std::size_t s = 0; s < stripes; ++s, p += StringHash__STRIPE) {
+
+            for(unsigned int i = 0; i < 8; ++i) {
+
+                std::uint64_t value = StringHash__read64(p + 8 * i);
+                std::uint64_t keyed = value ^ secret[i];
+
+                accumulators[i] += StringHash__read64(p + 8 * (i ^ 1)) +
+                    (keyed & 0xffffffffu) * (keyed >> 32);
+            }
+        }
+    }
+
+
+#ifdef STRING_HASHING_X86_DISPATCH
+    __attribute__((target("avx2")))
+    inline void StringHash__accumulateAvx2(std::uint64_t* accumulators,
+        const unsigned char* p, std::size_t stripes,
+        const std::uint64_t* secret) noexcept
+    {
+        __m256i low = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(accumulators));
+        __m256i high = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(accumulators + 4));
+        __m256i secretLow = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(secret));
+        __m256i secretHigh = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(secret + 4));
+
+        for(std::size_t s = 0; s < stripes; ++s, p += StringHash__STRIPE) {
+
+            __m256i dataLow = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(p));
+            __m256i dataHigh = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(p + 32));
+            __m256i keyedLow = _mm256_xor_si256(dataLow, secretLow);
+            __m256i keyedHigh = _mm256_xor_si256(dataHigh, secretHigh);
+
+            low = _mm256_add_epi64(low, _mm256_add_epi64(
+                _mm256_mul_epu32(keyedLow, _mm256_srli_epi64(keyedLow, 32)),
+                _mm256_shuffle_epi32(dataLow, _MM_SHUFFLE(1, 0, 3, 2))));
+            high = _mm256_add_epi64(high, _mm256_add_epi64(
+                _mm256_mul_epu32(keyedHigh, _mm256_srli_epi64(keyedHigh, 32)),
+                _mm256_shuffle_epi32(dataHigh, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators), low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators + 4), high);
+    }
+
+
+    __attribute__((target("sse4.2")))
+    inline std::uint32_t StringHash__crc32cHardware(const unsigned char* p,
+        std::size_t length, std::uint32_t crc) noexcept
+    {
+        std::uint64_t wide = crc;
+
+        for(; length >= 8; length -= 8, p += 8) {
+
+            wide = _mm_crc32_u64(wide, StringHash__read64(p));
+        }
+
+        crc = static_cast<std::uint32_t>(wide);
+
+        for(; length > 0; --length, ++p) {
+
+            crc = _mm_crc32_u8(crc, *p);
+        }
+
+        return crc;
+    }
+#endif
+
+
+    using StringHash__Accumulate = void (*)(std::uint64_t*,
+        const unsigned char*, std::size_t, const std::uint64_t*);
+
+
+    inline StringHash__Accumulate StringHash__selectAccumulate() noexcept
+    {
+#ifdef STRING_HASHING_X86_DISPATCH
+        if(__builtin_cpu_supports("avx2")) {
+
+            return StringHash__accumulateAvx2;
+        }
+#endif
+
+        return StringHash__accumulateScalar;
+    }
+
+
+    inline std::uint64_t StringHash__long(const unsigned char* p,
+        std::size_t length, std::uint64_t seed) noexcept
+    {
+        static const StringHash__Accumulate accumulate =
+            StringHash__selectAccumulate();
+
+        std::uint64_t secret[8], accumulators[8];
+        for(unsigned int i = 0; i < 8; ++i) {
+
+            secret[i] = StringHash__splitmix(seed + i);
+            accumulators[i] = secret[i] ^ StringHash__P2;
+        }
+
+        std::size_t stripes = length / StringHash__STRIPE;
+        accumulate(accumulators, p, stripes, secret);
+
+        std::uint64_t folded = length * StringHash__P0;
+        for(unsigned int i = 0; i < 8; i += 2) {
+
+            folded ^= StringHash__mum(accumulators[i] ^ secret[i + 1],
+                accumulators[i + 1] ^ secret[i]);
+        }
+
+        std::size_t tail = length - stripes * StringHash__STRIPE;
+
+        return StringHash__short(p + length - tail, tail, folded);
+    }
+
+
+    inline std::uint32_t StringHash__crc32cScalar(const unsigned char* p,
+        std::size_t length, std::uint32_t crc) noexcept
+    {
+        struct Table {
+
+            Table() noexcept
+            {
+                for(std::uint32_t i = 0; i < 256; ++i) {
+
+                    std::uint32_t entry = i;
+
+                    for(unsigned int bit = 0; bit < 8; ++bit) {
+
+                        entry = (entry >> 1) ^ (0x82f63b78u & (0u - (entry & 1)));
+                    }
+
+                    entries[i] = entry;
+                }
+            }
+
+            std::uint32_t entries[256];
+        };
+
+        static const Table table;
+
+        for(; length > 0; --length, ++p) {
+
+            crc = table.entries[(crc ^ *p) & 0xff] ^ (crc >> 8);
+        }
+
+        return crc;
+    }
+
+
+    inline std::uint32_t StringHash__crc32c(const unsigned char* p,
+        std::size_t length, std::uint32_t crc) noexcept
+    {
+#ifdef STRING_HASHING_X86_DISPATCH
+        static const bool hardware = __builtin_cpu_supports("sse4.2");
+
+        if(hardware) {
+
+            return StringHash__crc32cHardware(p, length, crc);
+        }
+#endif
+
+        return StringHash__crc32cScalar(p, length, crc);
+    }
+}
+
+
+inline std::uint64_t randomHashSeed()
+{
+    thread_local std::random_device device;
+    static std::atomic<std::uint64_t> counter{ 0 };
+
+    std::uint64_t seed = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    seed ^= static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+
+    return impl_::StringHash__splitmix(seed ^ ++counter);
+}
+
+
+inline std::uint64_t seededHash64(const void* data, std::size_t length,
+    std::uint64_t seed) noexcept
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+
+    if(length >= impl_::StringHash__LONG_KEY_THRESHOLD) {
+
+        return impl_::StringHash__long(p, length, seed);
+    }
+
+    return impl_::StringHash__short(p, length, seed);
+}
+
+
+inline unsigned int seededHash(const std::string& key,
+    std::uint64_t seed) noexcept
+{
+    std::uint64_t hash = seededHash64(key.data(), key.size(), seed);
+
+    return static_cast<unsigned int>(hash ^ (hash >> 32));
+}
+
+
+inline unsigned int crc32cHash(const std::string& key,
+    std::uint32_t seed) noexcept
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(key.data());
+
+    return ~impl_::StringHash__crc32c(p, key.size(), ~seed);
+}
+
+
+inline SeededStringHash::SeededStringHash(std::uint64_t seed) noexcept
+    : hashSeed{ seed }
+{
+}
+
+
+inline unsigned int SeededStringHash::operator()(
+    const std::string& key) const noexcept
+{
+    return seededHash(key, hashSeed);
+}
+
+
+inline std::uint64_t SeededStringHash::seed() const noexcept
+{
+    return hashSeed;
+}
+
+#endif // SEEDED_STRING_HASHING_HPP
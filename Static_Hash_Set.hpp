@@ -0,0 +1,204 @@
+// Static_Hash_Set.hpp
+#ifndef STATIC_HASH_SET_HPP
+#define STATIC_HASH_SET_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include "Hash_Table.hpp"
+
+// Hash usable in constant expressions. It hashes strings with 32-bit
+// FNV-1a and integers with the MurmurHash3 finalizer. It converts to
+// HashSet::HashFunction, so a fixed set and a HashSet of the same keys can
+// share one hash function.
+struct StaticHash
+{
+    constexpr unsigned int operator()(std::string_view key) const noexcept;
+
+    template <typename Integer, typename = typename std::enable_if<
+        std::is_integral<Integer>::value>::type>
+    constexpr unsigned int operator()(Integer key) const noexcept;
+};
+
+
+namespace impl_
+{
+    constexpr std::size_t StaticHashSet__capacity(std::size_t count) noexcept
+    {
+        std::size_t capacity = 2;
+
+        while(capacity < 2 * count) {
+
+            capacity *= 2;
+        }
+
+        return capacity;
+    }
+
+
+    constexpr unsigned int StaticHashSet__log2(std::size_t capacity) noexcept
+    {
+        unsigned int bits = 0;
+
+        while((std::size_t{ 1 } << bits) < capacity) {
+
+            ++bits;
+        }
+
+        return bits;
+    }
+}
+
+
+// Fixed set of literal-type elements, such as integers and string_views,
+// that can be built at compile time. Elements are placed by linear probing
+// into a power-of-two table that is at most half full. The constructor
+// records the longest probe sequence it needed, so contains() checks at
+// most that many slots and never touches the heap.
+//
+// The set stores string_views, not strings, so the characters must outlive
+// it. String literals always do.
+template <typename ElementType, std::size_t N, typename Hasher = StaticHash>
+class StaticHashSet
+{
+public:
+    static constexpr std::size_t CAPACITY = impl_::StaticHashSet__capacity(N);
+    static_assert(CAPACITY <= (std::size_t{ 1 } << 31),
+        "StaticHashSet is limited to 2^30 elements");
+
+public:
+    constexpr explicit StaticHashSet(const ElementType (&elements)[N],
+        Hasher hasher = Hasher{});
+
+    constexpr bool contains(const ElementType& element) const;
+    constexpr unsigned int size() const noexcept;
+    constexpr unsigned int maxProbeLength() const noexcept;
+
+private:
+    static constexpr unsigned int SHIFT =
+        32 - impl_::StaticHashSet__log2(CAPACITY);
+
+    Hasher hasher;
+    unsigned int sz = 0;
+    unsigned int maxProbe = 0;
+    unsigned int hashes[CAPACITY] = {};
+    bool occupied[CAPACITY] = {};
+    ElementType slots[CAPACITY] = {};
+
+    static constexpr std::size_t slotOf(unsigned int hash) noexcept;
+};
+
+
+// Deduces N from a braced list, so the element count need not be spelled:
+//     constexpr auto keywords = makeStaticHashSet<std::string_view>({
+//         "if", "else", "while" });
+template <typename ElementType, typename Hasher = StaticHash, std::size_t N>
+constexpr StaticHashSet<ElementType, N, Hasher> makeStaticHashSet(
+    const ElementType (&elements)[N], Hasher hasher = Hasher{})
+{
+    return StaticHashSet<ElementType, N, Hasher>{ elements, hasher };
+}
+
+
+constexpr unsigned int StaticHash::operator()(
+    std::string_view key) const noexcept
+{
+    unsigned int hash = 2166136261u;
+
+    for(char c : key) {
+
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+template <typename Integer, typename>
+constexpr unsigned int StaticHash::operator()(Integer key) const noexcept
+{
+    unsigned long long value = static_cast<unsigned long long>(key);
+
+    return impl_::HashTable__mix(
+        static_cast<unsigned int>(value ^ (value >> 32)));
+}
+
+
+// Repeated elements are kept once.
+template <typename ElementType, std::size_t N, typename Hasher>
+constexpr StaticHashSet<ElementType, N, Hasher>::StaticHashSet(
+    const ElementType (&elements)[N], Hasher hasher)
+    : hasher{ hasher }
+{
+    for(std::size_t i = 0; i < N; ++i) {
+
+        unsigned int hash = this->hasher(elements[i]);
+        std::size_t slot = slotOf(hash);
+        unsigned int probe = 0;
+
+        while(occupied[slot] &&
+            !(hashes[slot] == hash && slots[slot] == elements[i])) {
+
+            slot = (slot + 1) & (CAPACITY - 1);
+            ++probe;
+        }
+
+        if(!occupied[slot]) {
+
+            occupied[slot] = true;
+            hashes[slot] = hash;
+            slots[slot] = elements[i];
+            maxProbe = probe > maxProbe ? probe : maxProbe;
+            ++sz;
+        }
+    }
+}
+
+
+// Fibonacci hashing spreads weak hashes such as the identity over the
+// table before the high bits are taken.
+template <typename ElementType, std::size_t N, typename Hasher>
+constexpr std::size_t StaticHashSet<ElementType, N, Hasher>::slotOf(
+    unsigned int hash) noexcept
+{
+    return (hash * 2654435769u) >> SHIFT;
+}
+
+
+template <typename ElementType, std::size_t N, typename Hasher>
+constexpr bool StaticHashSet<ElementType, N, Hasher>::contains(
+    const ElementType& element) const
+{
+    unsigned int hash = hasher(element);
+    std::size_t slot = slotOf(hash);
+
+    for(unsigned int probe = 0; probe <= maxProbe; ++probe) {
+
+        if(hashes[slot] == hash && occupied[slot] && slots[slot] == element) {
+
+            return true;
+        }
+
+        slot = (slot + 1) & (CAPACITY - 1);
+    }
+
+    return false;
+}
+
+
+template <typename ElementType, std::size_t N, typename Hasher>
+constexpr unsigned int StaticHashSet<ElementType, N, Hasher>::size() const noexcept
+{
+    return sz;
+}
+
+
+template <typename ElementType, std::size_t N, typename Hasher>
+constexpr unsigned int StaticHashSet<ElementType, N, Hasher>::maxProbeLength()
+    const noexcept
+{
+    return maxProbe;
+}
+
+#endif // STATIC_HASH_SET_HPP
@@ -0,0 +1,143 @@
+// String_Hash_Benchmark.hpp
+#ifndef STRING_HASH_BENCHMARK_HPP
+#define STRING_HASH_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Throughput and quality of a string hash over keys of one length.
+// collisions counts keys whose full 32-bit hash equals an earlier key's.
+// bucketChiSquare is the chi-square statistic of the hashes' low bits over
+// a power-of-two bucket count, divided by the bucket count, so a random
+// hash scores close to 1 and larger values mean a lumpier spread.
+struct StringHashBenchmark
+{
+    std::size_t keyLength;
+    double nanosecondsPerHash;
+    double gigabytesPerSecond;
+    unsigned int collisions;
+    double bucketChiSquare;
+};
+
+
+// Returns count distinct keys of the given length. The keys are all the same
+// filler byte except for the key's index, written in little-endian order
+// into the middle of the key, so they differ in only a few bytes as
+// generated identifiers and URLs do. Keys shorter than four bytes can only
+// tell 256^length indices apart.
+inline std::vector<std::string> makeBenchmarkKeys(std::size_t count,
+    std::size_t length)
+{
+    std::vector<std::string> keys;
+    keys.reserve(count);
+
+    std::size_t width = std::min<std::size_t>(length, 4);
+    std::size_t start = (length - width) / 2;
+
+    for(std::size_t i = 0; i < count; ++i) {
+
+        std::string key(length, 'k');
+
+        for(std::size_t b = 0; b < width; ++b) {
+
+            key[start + b] = static_cast<char>((i >> (8 * b)) & 0xff);
+        }
+
+        keys.push_back(std::move(key));
+    }
+
+    return keys;
+}
+
+
+// Hashes keysPerLength keys of each entry of keyLengths, repeating the pass
+// until at least minimumBytes have been hashed so short keys are timed
+// over a useful interval. The hash is called through std::function, as
+// HashSet calls it.
+inline std::vector<StringHashBenchmark> benchmarkStringHash(
+    const std::function<unsigned int(const std::string&)>& hash,
+    const std::vector<std::size_t>& keyLengths,
+    std::size_t keysPerLength = 1u << 16,
+    std::size_t minimumBytes = std::size_t{ 1 } << 28)
+{
+    std::vector<StringHashBenchmark> results;
+
+    for(std::size_t length : keyLengths) {
+
+        std::vector<std::string> keys = makeBenchmarkKeys(keysPerLength, length);
+        std::vector<unsigned int> hashes(keys.size());
+
+        if(keys.empty()) {
+
+            continue;
+        }
+
+        std::size_t passBytes = std::max<std::size_t>(length, 1) * keys.size();
+        std::size_t passes = std::max<std::size_t>(minimumBytes / passBytes, 1);
+        volatile unsigned int sink = 0;
+        unsigned int folded = 0;
+
+        auto started = std::chrono::steady_clock::now();
+
+        for(std::size_t pass = 0; pass < passes; ++pass) {
+
+            for(const std::string& key : keys) {
+
+                folded ^= hash(key);
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - started).count();
+        sink = folded;
+        static_cast<void>(sink);
+
+        for(std::size_t i = 0; i < keys.size(); ++i) {
+
+            hashes[i] = hash(keys[i]);
+        }
+
+        std::size_t bucketCount = 1;
+        while(bucketCount < keys.size()) {
+
+            bucketCount *= 2;
+        }
+
+        std::vector<unsigned int> buckets(bucketCount, 0);
+        for(unsigned int h : hashes) {
+
+            ++buckets[h & (bucketCount - 1)];
+        }
+
+        double expected = static_cast<double>(keys.size()) / bucketCount;
+        double chiSquare = 0.0;
+        for(unsigned int observed : buckets) {
+
+            double difference = observed - expected;
+            chiSquare += difference * difference / expected;
+        }
+
+        std::sort(hashes.begin(), hashes.end());
+
+        StringHashBenchmark result;
+        result.keyLength = length;
+        result.nanosecondsPerHash = seconds * 1e9 / (passes * keys.size());
+        result.gigabytesPerSecond = seconds > 0.0 ?
+            static_cast<double>(length) * passes * keys.size() / seconds / 1e9 :
+            0.0;
+        result.collisions = static_cast<unsigned int>(hashes.size() -
+            (std::unique(hashes.begin(), hashes.end()) - hashes.begin()));
+        result.bucketChiSquare = chiSquare / bucketCount;
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+#endif // STRING_HASH_BENCHMARK_HPP
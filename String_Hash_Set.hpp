@@ -0,0 +1,427 @@
+// String_Hash_Set.hpp
+#ifndef STRING_HASH_SET_HPP
+#define STRING_HASH_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Hash_Table.hpp"
+#include "Set.hpp"
+#include "StringHashing.hpp"
+
+// Open-addressing set of strings that keeps the key bytes out of
+// std::string. A slot is 16 bytes: the cached hash, the length, and either
+// the key itself when it fits in INLINE_CAPACITY bytes or a pointer into a
+// bump-allocated arena. Lookups compare hash and length before touching any
+// key bytes, so most misses never leave the slot array.
+//
+// The arena is only released as a whole, so the bytes of removed long keys
+// stay allocated until the set is destroyed or assigned over.
+class StringHashSet : public Set<std::string>
+{
+public:
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+    static constexpr double MAX_LOAD_FACTOR = 0.75;
+    static constexpr std::size_t INLINE_CAPACITY = sizeof(const char*);
+    static constexpr std::size_t ARENA_CHUNK_SIZE = 64 * 1024;
+    using HashFunction = std::function<unsigned int(const std::string&)>;
+
+public:
+    explicit StringHashSet(HashFunction hashFunction = bernsteinHash);
+    ~StringHashSet() noexcept override;
+
+    StringHashSet(const StringHashSet& s);
+    StringHashSet(StringHashSet&& s) noexcept;
+
+    StringHashSet& operator=(const StringHashSet& s);
+    StringHashSet& operator=(StringHashSet&& s) noexcept;
+
+    bool isImplemented() const noexcept override;
+    void add(const std::string& element) override;
+    bool insert(const std::string& element);
+    bool remove(const std::string& element);
+    bool contains(const std::string& element) const override;
+    unsigned int size() const noexcept override;
+
+    unsigned int bucketCount() const noexcept;
+    double loadFactor() const noexcept;
+    void reserve(unsigned int count);
+    std::size_t bytesAllocated() const noexcept;
+
+private:
+    static constexpr std::uint32_t EMPTY = 0xffffffffu;
+
+    struct Slot {
+
+        std::uint32_t hash;
+        std::uint32_t length;
+
+        union {
+
+            char bytes[INLINE_CAPACITY];
+            const char* pointer;
+        };
+    };
+
+    HashFunction hashFunction;
+    std::unique_ptr<Slot[]> slots;
+    unsigned int sz, capacity;
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* cursor;
+    std::size_t remaining;
+    std::size_t arenaBytes;
+
+    static const char* keyOf(const Slot& slot) noexcept;
+
+    void allocate(unsigned int newCapacity);
+    void rehashTo(unsigned int newCapacity);
+    char* arenaAllocate(std::size_t count);
+    void copyFrom(const StringHashSet& s);
+    void place(const Slot& slot) noexcept;
+    int findIndex(std::uint32_t hash, const std::string& element) const;
+};
+
+
+inline StringHashSet::StringHashSet(HashFunction hashFunction)
+    : hashFunction{ hashFunction }, sz{ 0 }, capacity{ 0 },
+      cursor{ nullptr }, remaining{ 0 }, arenaBytes{ 0 }
+{
+    allocate(DEFAULT_CAPACITY);
+}
+
+
+inline StringHashSet::~StringHashSet() noexcept
+{
+}
+
+
+inline StringHashSet::StringHashSet(const StringHashSet& s)
+    : hashFunction{ s.hashFunction }, sz{ 0 }, capacity{ 0 },
+      cursor{ nullptr }, remaining{ 0 }, arenaBytes{ 0 }
+{
+    copyFrom(s);
+}
+
+
+// Leaves s without slots. Every member treats capacity 0 as an empty set,
+// and the next insert allocates DEFAULT_CAPACITY slots.
+inline StringHashSet::StringHashSet(StringHashSet&& s) noexcept
+    : hashFunction{ s.hashFunction }, slots{ std::move(s.slots) },
+      sz{ s.sz }, capacity{ s.capacity }, chunks{ std::move(s.chunks) },
+      cursor{ s.cursor }, remaining{ s.remaining }, arenaBytes{ s.arenaBytes }
+{
+    s.sz = 0;
+    s.capacity = 0;
+    s.cursor = nullptr;
+    s.remaining = 0;
+    s.arenaBytes = 0;
+}
+
+
+inline StringHashSet& StringHashSet::operator=(const StringHashSet& s)
+{
+    if(this != &s) {
+
+        StringHashSet copy{ s };
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+inline StringHashSet& StringHashSet::operator=(StringHashSet&& s) noexcept
+{
+    if(this != &s) {
+
+        std::swap(hashFunction, s.hashFunction);
+        std::swap(slots, s.slots);
+        std::swap(sz, s.sz);
+        std::swap(capacity, s.capacity);
+        std::swap(chunks, s.chunks);
+        std::swap(cursor, s.cursor);
+        std::swap(remaining, s.remaining);
+        std::swap(arenaBytes, s.arenaBytes);
+    }
+
+    return *this;
+}
+
+
+inline const char* StringHashSet::keyOf(const Slot& slot) noexcept
+{
+    return slot.length <= INLINE_CAPACITY ? slot.bytes : slot.pointer;
+}
+
+
+inline void StringHashSet::allocate(unsigned int newCapacity)
+{
+    slots.reset(new Slot[newCapacity]);
+    capacity = newCapacity;
+
+    for(unsigned int i = 0; i < capacity; ++i) {
+
+        slots[i].length = EMPTY;
+    }
+}
+
+
+// Only the slot array moves; long keys stay where they are in the arena.
+inline void StringHashSet::rehashTo(unsigned int newCapacity)
+{
+    std::unique_ptr<Slot[]> oldSlots = std::move(slots);
+    unsigned int oldCapacity = capacity;
+
+    allocate(newCapacity);
+
+    for(unsigned int i = 0; i < oldCapacity; ++i) {
+
+        if(oldSlots[i].length != EMPTY) {
+
+            place(oldSlots[i]);
+        }
+    }
+}
+
+
+inline char* StringHashSet::arenaAllocate(std::size_t count)
+{
+    if(count > remaining) {
+
+        std::size_t chunkSize = count > ARENA_CHUNK_SIZE ? count :
+            ARENA_CHUNK_SIZE;
+
+        chunks.emplace_back(new char[chunkSize]);
+        cursor = chunks.back().get();
+        remaining = chunkSize;
+        arenaBytes += chunkSize;
+    }
+
+    char* block = cursor;
+    cursor += count;
+    remaining -= count;
+
+    return block;
+}
+
+
+// Copies only the live keys, which also drops the arena bytes of removed
+// ones.
+inline void StringHashSet::copyFrom(const StringHashSet& s)
+{
+    unsigned int newCapacity = DEFAULT_CAPACITY;
+    while(s.sz > newCapacity * MAX_LOAD_FACTOR) {
+
+        newCapacity *= 2;
+    }
+
+    allocate(newCapacity);
+
+    for(unsigned int i = 0; i < s.capacity; ++i) {
+
+        Slot slot = s.slots[i];
+
+        if(slot.length == EMPTY) {
+
+            continue;
+        }
+
+        if(slot.length > INLINE_CAPACITY) {
+
+            char* key = arenaAllocate(slot.length);
+            std::memcpy(key, slot.pointer, slot.length);
+            slot.pointer = key;
+        }
+
+        place(slot);
+        sz++;
+    }
+}
+
+
+inline void StringHashSet::place(const Slot& slot) noexcept
+{
+    unsigned int mask = capacity - 1;
+    unsigned int index = slot.hash & mask;
+
+    while(slots[index].length != EMPTY) {
+
+        index = (index + 1) & mask;
+    }
+
+    slots[index] = slot;
+}
+
+
+inline int StringHashSet::findIndex(std::uint32_t hash,
+    const std::string& element) const
+{
+    if(capacity == 0) {
+
+        return -1;
+    }
+
+    unsigned int mask = capacity - 1;
+    unsigned int index = hash & mask;
+
+    while(slots[index].length != EMPTY) {
+
+        const Slot& slot = slots[index];
+
+        if(slot.hash == hash && slot.length == element.size() &&
+            std::memcmp(keyOf(slot), element.data(), slot.length) == 0) {
+
+            return static_cast<int>(index);
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return -1;
+}
+
+
+inline bool StringHashSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+inline void StringHashSet::add(const std::string& element)
+{
+    insert(element);
+}
+
+
+inline bool StringHashSet::insert(const std::string& element)
+{
+    if(element.size() >= EMPTY) {
+
+        throw std::length_error{ "String is too long for StringHashSet!" };
+    }
+
+    std::uint32_t hash = impl_::HashTable__mix(hashFunction(element));
+
+    if(findIndex(hash, element) >= 0) {
+
+        return false;
+    }
+
+    if(sz + 1 > capacity * MAX_LOAD_FACTOR) {
+
+        rehashTo(capacity == 0 ? DEFAULT_CAPACITY : capacity * 2);
+    }
+
+    Slot slot;
+    slot.hash = hash;
+    slot.length = static_cast<std::uint32_t>(element.size());
+
+    if(slot.length <= INLINE_CAPACITY) {
+
+        std::memcpy(slot.bytes, element.data(), slot.length);
+    }
+    else {
+
+        char* key = arenaAllocate(slot.length);
+        std::memcpy(key, element.data(), slot.length);
+        slot.pointer = key;
+    }
+
+    place(slot);
+    sz++;
+
+    return true;
+}
+
+
+// Linear-probing deletion: later slots of the run move back into the hole
+// unless their home slot lies cyclically between the hole and themselves.
+inline bool StringHashSet::remove(const std::string& element)
+{
+    std::uint32_t hash = impl_::HashTable__mix(hashFunction(element));
+    int found = findIndex(hash, element);
+
+    if(found < 0) {
+
+        return false;
+    }
+
+    unsigned int mask = capacity - 1;
+    unsigned int hole = static_cast<unsigned int>(found);
+    unsigned int next = (hole + 1) & mask;
+
+    while(slots[next].length != EMPTY) {
+
+        unsigned int home = slots[next].hash & mask;
+
+        if(((next - home) & mask) >= ((next - hole) & mask)) {
+
+            slots[hole] = slots[next];
+            hole = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    slots[hole].length = EMPTY;
+    sz--;
+
+    return true;
+}
+
+
+inline bool StringHashSet::contains(const std::string& element) const
+{
+    std::uint32_t hash = impl_::HashTable__mix(hashFunction(element));
+
+    return findIndex(hash, element) >= 0;
+}
+
+
+inline unsigned int StringHashSet::size() const noexcept
+{
+    return sz;
+}
+
+
+inline unsigned int StringHashSet::bucketCount() const noexcept
+{
+    return capacity;
+}
+
+
+inline double StringHashSet::loadFactor() const noexcept
+{
+    return capacity == 0 ? 0.0 : static_cast<double>(sz) / capacity;
+}
+
+
+inline void StringHashSet::reserve(unsigned int count)
+{
+    unsigned int newCapacity = capacity == 0 ? DEFAULT_CAPACITY : capacity;
+
+    while(count > newCapacity * MAX_LOAD_FACTOR) {
+
+        newCapacity *= 2;
+    }
+
+    if(newCapacity != capacity) {
+
+        rehashTo(newCapacity);
+    }
+}
+
+
+inline std::size_t StringHashSet::bytesAllocated() const noexcept
+{
+    return sizeof(Slot) * capacity + arenaBytes;
+}
+
+#endif // STRING_HASH_SET_HPP